@@ -0,0 +1,369 @@
+#include "batch_io.h"
+#include "trace.h"
+#include <algorithm>
+#include <cstring>
+#include <zlib.h>
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace {
+
+const size_t CHUNK_SIZE = 1 << 16;
+
+bool endsWith(const std::string& text, const std::string& suffix) {
+    return text.size() >= suffix.size() &&
+           text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+}
+
+Compression compressionForPath(const std::string& path) {
+    if (endsWith(path, ".gz")) return Compression::Gzip;
+    if (endsWith(path, ".zst")) return Compression::Zstd;
+    return Compression::None;
+}
+
+bool compressionSupported(Compression compression) {
+#ifdef HAVE_ZSTD
+    (void)compression;
+    return true;
+#else
+    return compression != Compression::Zstd;
+#endif
+}
+
+LineSource::LineSource(const std::string& path, size_t batchLines, size_t maxQueuedBatches)
+    : file(path, std::ios::binary), opened(file.is_open()),
+      batchLines(std::max<size_t>(batchLines, 1)), maxQueuedBatches(std::max<size_t>(maxQueuedBatches, 1)),
+      finished(false), stopping(false) {
+    if (opened) {
+        reader = std::thread(&LineSource::run, this);
+    }
+}
+
+LineSource::~LineSource() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    changed.notify_all();
+    if (reader.joinable()) {
+        reader.join();
+    }
+}
+
+bool LineSource::next(std::vector<std::string>& batch) {
+    TRACE_STAGE("wait input");
+    std::unique_lock<std::mutex> lock(mutex);
+    changed.wait(lock, [this] { return !queue.empty() || finished; });
+    if (queue.empty()) {
+        return false;
+    }
+    batch = std::move(queue.front());
+    queue.pop_front();
+    changed.notify_all();
+    return true;
+}
+
+std::string LineSource::error() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return errorMessage;
+}
+
+size_t LineSource::readChunk(std::vector<char>& buffer) {
+    if (!file) return 0;
+    TRACE_STAGE("read chunk");
+    file.read(buffer.data(), buffer.size());
+    return (size_t)file.gcount();
+}
+
+void LineSource::run() {
+    TRACE_THREAD_NAME("reader");
+    std::vector<char> buffer(CHUNK_SIZE);
+    size_t size = readChunk(buffer);
+    const unsigned char* magic = (const unsigned char*)buffer.data();
+
+    if (size >= 2 && magic[0] == 0x1f && magic[1] == 0x8b) {
+        readGzip(buffer, size);
+    } else if (size >= 4 && magic[0] == 0x28 && magic[1] == 0xb5 && magic[2] == 0x2f && magic[3] == 0xfd) {
+        readZstd(buffer, size);
+    } else {
+        readPlain(buffer, size);
+    }
+}
+
+void LineSource::readPlain(std::vector<char>& buffer, size_t size) {
+    while (size > 0) {
+        if (!addBytes(buffer.data(), size)) return;
+        size = readChunk(buffer);
+    }
+    finish("");
+}
+
+void LineSource::readGzip(std::vector<char>& buffer, size_t size) {
+    z_stream zs;
+    std::memset(&zs, 0, sizeof(zs));
+    if (inflateInit2(&zs, 15 + 32) != Z_OK) {
+        finish("Cannot initialise gzip decoder");
+        return;
+    }
+
+    std::vector<char> out(CHUNK_SIZE);
+    zs.next_in = (Bytef*)buffer.data();
+    zs.avail_in = (uInt)size;
+    bool memberEnded = false;
+    bool outputFull = false;
+    std::string error;
+    while (true) {
+        if (zs.avail_in == 0 && !outputFull) {
+            size = readChunk(buffer);
+            if (size == 0) break;
+            zs.next_in = (Bytef*)buffer.data();
+            zs.avail_in = (uInt)size;
+        }
+        // Concatenated gzip members decode as one stream, like gunzip.
+        if (memberEnded) {
+            inflateReset(&zs);
+            memberEnded = false;
+        }
+
+        zs.next_out = (Bytef*)out.data();
+        zs.avail_out = (uInt)out.size();
+        int ret = inflate(&zs, Z_NO_FLUSH);
+        if (ret != Z_OK && ret != Z_STREAM_END && ret != Z_BUF_ERROR) {
+            error = "Corrupt gzip input";
+            break;
+        }
+        if (!addBytes(out.data(), out.size() - zs.avail_out)) {
+            inflateEnd(&zs);
+            return;
+        }
+        outputFull = zs.avail_out == 0 && ret != Z_STREAM_END;
+        memberEnded = ret == Z_STREAM_END;
+    }
+    inflateEnd(&zs);
+
+    if (error.empty() && !memberEnded) {
+        error = "Truncated gzip input";
+    }
+    finish(error);
+}
+
+void LineSource::readZstd(std::vector<char>& buffer, size_t size) {
+#ifdef HAVE_ZSTD
+    ZSTD_DStream* stream = ZSTD_createDStream();
+    if (!stream || ZSTD_isError(ZSTD_initDStream(stream))) {
+        ZSTD_freeDStream(stream);
+        finish("Cannot initialise zstd decoder");
+        return;
+    }
+
+    std::vector<char> out(ZSTD_DStreamOutSize());
+    ZSTD_inBuffer in = {buffer.data(), size, 0};
+    size_t remaining = 0;
+    bool outputFull = false;
+    std::string error;
+    while (true) {
+        if (in.pos == in.size && !outputFull) {
+            size = readChunk(buffer);
+            if (size == 0) break;
+            in = {buffer.data(), size, 0};
+        }
+
+        ZSTD_outBuffer output = {out.data(), out.size(), 0};
+        remaining = ZSTD_decompressStream(stream, &output, &in);
+        if (ZSTD_isError(remaining)) {
+            error = std::string("Corrupt zstd input: ") + ZSTD_getErrorName(remaining);
+            break;
+        }
+        if (!addBytes(out.data(), output.pos)) {
+            ZSTD_freeDStream(stream);
+            return;
+        }
+        outputFull = output.pos == output.size;
+    }
+    ZSTD_freeDStream(stream);
+
+    if (error.empty() && remaining != 0) {
+        error = "Truncated zstd input";
+    }
+    finish(error);
+#else
+    (void)buffer;
+    (void)size;
+    finish("zstd input is not supported in this build (compile with -DHAVE_ZSTD -lzstd)");
+#endif
+}
+
+bool LineSource::addBytes(const char* data, size_t size) {
+    const char* end = data + size;
+    while (data < end) {
+        const char* newline = (const char*)std::memchr(data, '\n', end - data);
+        if (!newline) {
+            partialLine.append(data, end);
+            break;
+        }
+        partialLine.append(data, newline);
+        takePartialLine();
+        data = newline + 1;
+
+        if (pending.size() >= batchLines && !pushBatch()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// The file is read in binary mode, so CRLF input (e.g. written on Windows)
+// has its '\r' dropped here, as a text-mode getline would.
+void LineSource::takePartialLine() {
+    if (!partialLine.empty() && partialLine.back() == '\r') {
+        partialLine.pop_back();
+    }
+    pending.push_back(std::move(partialLine));
+    partialLine.clear();
+}
+
+bool LineSource::pushBatch() {
+    TRACE_STAGE("push batch");
+    std::unique_lock<std::mutex> lock(mutex);
+    changed.wait(lock, [this] { return queue.size() < maxQueuedBatches || stopping; });
+    if (stopping) {
+        return false;
+    }
+    queue.push_back(std::move(pending));
+    pending.clear();
+    changed.notify_all();
+    return true;
+}
+
+void LineSource::finish(const std::string& error) {
+    if (!partialLine.empty()) {
+        takePartialLine();
+    }
+    if (!pending.empty() && !pushBatch()) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    finished = true;
+    errorMessage = error;
+    changed.notify_all();
+}
+
+struct LineSink::Encoder {
+    z_stream zs;
+#ifdef HAVE_ZSTD
+    ZSTD_CStream* zstd = nullptr;
+#endif
+    std::vector<char> out;
+};
+
+LineSink::LineSink(const std::string& path, Compression compression)
+    : opened(false), compression(compression) {
+    if (!compressionSupported(compression)) {
+        return;
+    }
+    file.open(path, std::ios::binary);
+    if (!file.is_open()) {
+        return;
+    }
+
+    encoder.reset(new Encoder());
+    encoder->out.resize(CHUNK_SIZE);
+    if (compression == Compression::Gzip) {
+        std::memset(&encoder->zs, 0, sizeof(encoder->zs));
+        if (deflateInit2(&encoder->zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+            return;
+        }
+    }
+#ifdef HAVE_ZSTD
+    if (compression == Compression::Zstd) {
+        encoder->zstd = ZSTD_createCStream();
+        if (!encoder->zstd || ZSTD_isError(ZSTD_initCStream(encoder->zstd, 3))) {
+            ZSTD_freeCStream(encoder->zstd);
+            encoder->zstd = nullptr;
+            return;
+        }
+    }
+#endif
+    opened = true;
+}
+
+LineSink::~LineSink() {
+    close();
+}
+
+void LineSink::writeLine(const std::string& line) {
+    buffer += line;
+    buffer += '\n';
+    if (buffer.size() >= CHUNK_SIZE) {
+        flushBuffer(false);
+    }
+}
+
+bool LineSink::close() {
+    if (!opened) {
+        return false;
+    }
+    bool ok = flushBuffer(true);
+    if (compression == Compression::Gzip) {
+        deflateEnd(&encoder->zs);
+    }
+#ifdef HAVE_ZSTD
+    if (encoder->zstd) {
+        ZSTD_freeCStream(encoder->zstd);
+        encoder->zstd = nullptr;
+    }
+#endif
+    file.close();
+    opened = false;
+    return ok && !file.fail();
+}
+
+bool LineSink::flushBuffer(bool finish) {
+    TRACE_STAGE("write chunk");
+    std::vector<char>& out = encoder->out;
+
+    if (compression == Compression::None) {
+        file.write(buffer.data(), buffer.size());
+    } else if (compression == Compression::Gzip) {
+        z_stream& zs = encoder->zs;
+        zs.next_in = (Bytef*)buffer.data();
+        zs.avail_in = (uInt)buffer.size();
+        int flush = finish ? Z_FINISH : Z_NO_FLUSH;
+        int ret;
+        do {
+            zs.next_out = (Bytef*)out.data();
+            zs.avail_out = (uInt)out.size();
+            ret = deflate(&zs, flush);
+            if (ret == Z_STREAM_ERROR) {
+                return false;
+            }
+            file.write(out.data(), out.size() - zs.avail_out);
+        } while (zs.avail_out == 0 || (finish && ret != Z_STREAM_END));
+    } else {
+#ifdef HAVE_ZSTD
+        ZSTD_inBuffer in = {buffer.data(), buffer.size(), 0};
+        while (in.pos < in.size) {
+            ZSTD_outBuffer output = {out.data(), out.size(), 0};
+            if (ZSTD_isError(ZSTD_compressStream(encoder->zstd, &output, &in))) {
+                return false;
+            }
+            file.write(out.data(), output.pos);
+        }
+        size_t remaining = finish ? 1 : 0;
+        while (remaining > 0) {
+            ZSTD_outBuffer output = {out.data(), out.size(), 0};
+            remaining = ZSTD_endStream(encoder->zstd, &output);
+            if (ZSTD_isError(remaining)) {
+                return false;
+            }
+            file.write(out.data(), output.pos);
+        }
+#endif
+    }
+    buffer.clear();
+    return true;
+}
@@ -0,0 +1,82 @@
+#ifndef BATCH_IO_H
+#define BATCH_IO_H
+
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum class Compression { None, Gzip, Zstd };
+
+// Compression named by the file extension (.gz / .zst); used for output.
+Compression compressionForPath(const std::string& path);
+bool compressionSupported(Compression compression);
+
+// Reads a plain, gzip or zstd file (detected from its first bytes) on a
+// background thread and hands out batches of lines, so decompression
+// overlaps with whatever the caller does with the previous batch.
+class LineSource {
+public:
+    explicit LineSource(const std::string& path, size_t batchLines = 1024, size_t maxQueuedBatches = 8);
+    ~LineSource();
+
+    bool isOpen() const { return opened; }
+    // Blocks until a batch is ready; returns false once the input is done.
+    bool next(std::vector<std::string>& batch);
+    std::string error();
+
+private:
+    std::ifstream file;
+    bool opened;
+    size_t batchLines;
+    size_t maxQueuedBatches;
+
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::deque<std::vector<std::string>> queue;
+    bool finished;
+    bool stopping;
+    std::string errorMessage;
+
+    std::vector<std::string> pending;
+    std::string partialLine;
+    std::thread reader;
+
+    void run();
+    size_t readChunk(std::vector<char>& buffer);
+    void readPlain(std::vector<char>& buffer, size_t size);
+    void readGzip(std::vector<char>& buffer, size_t size);
+    void readZstd(std::vector<char>& buffer, size_t size);
+    bool addBytes(const char* data, size_t size);
+    void takePartialLine();
+    bool pushBatch();
+    void finish(const std::string& error);
+};
+
+// Writes lines to a plain file or through a streaming gzip/zstd compressor.
+class LineSink {
+public:
+    LineSink(const std::string& path, Compression compression);
+    ~LineSink();
+
+    bool isOpen() const { return opened; }
+    void writeLine(const std::string& line);
+    bool close();
+
+private:
+    struct Encoder;
+
+    std::ofstream file;
+    bool opened;
+    Compression compression;
+    std::string buffer;
+    std::unique_ptr<Encoder> encoder;
+
+    bool flushBuffer(bool finish);
+};
+
+#endif
@@ -0,0 +1,56 @@
+#include "card_box.h"
+
+Fl_Offscreen CardBox::faceCache[14] = {};
+int CardBox::cacheW = 0;
+int CardBox::cacheH = 0;
+
+CardBox::CardBox(int x, int y, int w, int h)
+    : Fl_Box(x, y, w, h), currentFace(0) {
+    box(FL_UP_BOX);
+    color(FL_WHITE);
+}
+
+void CardBox::face(int value) {
+    if (value < 0 || value > 13) value = 0;
+    if (value == currentFace) return;
+    currentFace = value;
+    redraw();
+}
+
+const char* CardBox::faceText(int face) {
+    static const char* texts[14] = {"", "A", "2", "3", "4", "5", "6", "7", "8", "9", "10", "J", "Q", "K"};
+    return (face >= 0 && face <= 13) ? texts[face] : "";
+}
+
+void CardBox::renderFace(int face) {
+    faceCache[face] = fl_create_offscreen(w(), h());
+    fl_begin_offscreen(faceCache[face]);
+    fl_draw_box(box(), 0, 0, w(), h(), color());
+    fl_font(labelfont(), labelsize());
+    fl_color(labelcolor());
+    fl_draw(faceText(face), 0, 0, w(), h(), FL_ALIGN_CENTER);
+    fl_end_offscreen();
+}
+
+void CardBox::draw() {
+    if (w() != cacheW || h() != cacheH) {
+        clearCache();
+        cacheW = w();
+        cacheH = h();
+    }
+    if (!faceCache[currentFace]) {
+        renderFace(currentFace);
+    }
+    fl_copy_offscreen(x(), y(), w(), h(), faceCache[currentFace], 0, 0);
+}
+
+void CardBox::clearCache() {
+    for (Fl_Offscreen& offscreen : faceCache) {
+        if (offscreen) {
+            fl_delete_offscreen(offscreen);
+            offscreen = 0;
+        }
+    }
+    cacheW = 0;
+    cacheH = 0;
+}
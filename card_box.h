@@ -0,0 +1,33 @@
+#ifndef CARD_BOX_H
+#define CARD_BOX_H
+
+#include <FL/Fl.H>
+#include <FL/Fl_Box.H>
+#include <FL/fl_draw.H>
+
+// A playing card that renders each face (A-K) once into an offscreen buffer
+// shared by all cards, then just blits the buffer on later redraws.
+class CardBox : public Fl_Box {
+private:
+    int currentFace;
+
+    static Fl_Offscreen faceCache[14];
+    static int cacheW;
+    static int cacheH;
+
+    void renderFace(int face);
+
+protected:
+    void draw() override;
+
+public:
+    CardBox(int x, int y, int w, int h);
+
+    int face() const { return currentFace; }
+    void face(int value);
+
+    static const char* faceText(int face);
+    static void clearCache();
+};
+
+#endif
@@ -0,0 +1,292 @@
+#include "game_session.h"
+#include "solve24.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <stack>
+#include <stdexcept>
+
+GameSession::GameSession()
+    : GameSession(steadyClock, [] { return randomSolvableHand(); }) {
+}
+
+GameSession::GameSession(Clock clock, HandSource handSource)
+    : clock(clock), handSource(handSource) {
+    selectedTime = 60;
+    stoppedRemaining = selectedTime;
+    roundStart = 0;
+    isTimerRunning = false;
+    roundSolved = false;
+    currentScore = 0;
+    comboCount = 0;
+    isFirstTry = true;
+    lastRoundPoints = 0;
+}
+
+double GameSession::steadyClock() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+std::vector<int> GameSession::randomSolvableHand(SolveStats* stats, int* rejectedHands) {
+    std::vector<int> tempCards;
+    if (rejectedHands) *rejectedHands = 0;
+    while (true) {
+        tempCards.clear();
+        for (int i = 0; i < 4; i++) {
+            tempCards.push_back(rand() % 13 + 1);
+        }
+        
+        std::vector<double> nums(tempCards.begin(), tempCards.end());
+        std::vector<std::string> exprs;
+        for (int num : tempCards) {
+            exprs.push_back(std::to_string(num));
+        }
+        
+        std::string solution;
+        SolveStats handStats;
+        if (solve24(nums, exprs, solution, SolveOptions(), &handStats)) {
+            if (stats) *stats = handStats;
+            return tempCards;
+        }
+        if (rejectedHands) (*rejectedHands)++;
+    }
+}
+
+void GameSession::setRoundTime(int seconds) {
+    selectedTime = seconds;
+    if (!isTimerRunning) {
+        stoppedRemaining = selectedTime;
+    }
+}
+
+int GameSession::remainingTime() const {
+    if (!isTimerRunning) {
+        return stoppedRemaining;
+    }
+    int elapsed = (int)std::floor(clock() - roundStart);
+    return std::max(0, selectedTime - elapsed);
+}
+
+bool GameSession::startRound() {
+    bool newGame = !isTimerRunning;
+    if (newGame) {
+        currentScore = 0;
+        comboCount = 0;
+    }
+    
+    currentCards = handSource();
+    roundStart = clock();
+    isTimerRunning = true;
+    roundSolved = false;
+    isFirstTry = true;
+    lastRoundPoints = 0;
+    return newGame;
+}
+
+bool GameSession::update() {
+    if (!isTimerRunning || roundSolved) {
+        return false;
+    }
+    if (remainingTime() > 0) {
+        return false;
+    }
+    isTimerRunning = false;
+    stoppedRemaining = 0;
+    return true;
+}
+
+CheckResult GameSession::check(const std::string& answer) {
+    if (!isTimerRunning) {
+        return CheckResult::NotRunning;
+    }
+    if (currentCards.empty()) {
+        return CheckResult::NoCards;
+    }
+    if (roundSolved) {
+        return CheckResult::AlreadySolved;
+    }
+    if (answer.empty()) {
+        return CheckResult::Empty;
+    }
+    
+    if (validateAnswer(currentCards, answer)) {
+        lastRoundPoints = calculateScore(remainingTime());
+        currentScore += lastRoundPoints;
+        comboCount++;
+        roundSolved = true;
+        return CheckResult::Correct;
+    }
+    
+    comboCount = 0;
+    currentScore = std::max(0, currentScore - 50);
+    isFirstTry = false;
+    return CheckResult::Wrong;
+}
+
+void GameSession::reset() {
+    isTimerRunning = false;
+    stoppedRemaining = selectedTime;
+    roundSolved = false;
+    currentCards.clear();
+    currentScore = 0;
+    comboCount = 0;
+    isFirstTry = true;
+    lastRoundPoints = 0;
+}
+
+int GameSession::calculateScore(int remaining) const {
+    int baseScore = 100;
+    double timeMultiplier;
+    
+    
+    if (remaining >= 45) timeMultiplier = 1.5;
+    else if (remaining >= 30) timeMultiplier = 1.2;
+    else if (remaining >= 15) timeMultiplier = 1.0;
+    else timeMultiplier = 0.8;
+    
+    
+    int finalScore = baseScore * timeMultiplier;
+    
+    
+    if (isFirstTry) {
+        finalScore += 50;
+    }
+    
+    
+    finalScore += comboCount * 10;
+    return finalScore;
+}
+
+bool GameSession::validateAnswer(const std::vector<int>& cards, const std::string& answer) {
+    if (!usesExactlyCards(cards, answer)) {
+        return false;
+    }
+    
+    try {
+        double result = evaluateExpression(answer);
+        return fabs(result - 24.0) < 1e-6;  
+    } catch (const std::runtime_error& e) {
+        return false;
+    }
+}
+
+bool GameSession::usesExactlyCards(const std::vector<int>& cards, const std::string& answer) {
+    std::vector<int> usedNumbers;
+    std::string num;
+    for (size_t i = 0; i < answer.length(); i++) {
+        if (isdigit(answer[i])) {
+            num += answer[i];
+            // No card is above 13, and longer runs would overflow stoi.
+            if (num.size() > 2) {
+                return false;
+            }
+            
+            if (i + 1 == answer.length() || !isdigit(answer[i + 1])) {
+                usedNumbers.push_back(std::stoi(num));
+                num.clear();
+            }
+        }
+    }
+    
+    
+    if (usedNumbers.size() != cards.size()) {
+        return false;
+    }
+    
+    
+    std::vector<int> availableCards = cards;
+    
+    
+    for (int num : usedNumbers) {
+        auto it = std::find(availableCards.begin(), availableCards.end(), num);
+        if (it == availableCards.end()) {
+            return false;  
+        }
+        
+        availableCards.erase(it);
+    }
+    return true;
+}
+
+void GameSession::reduceTop(std::stack<double>& values, std::stack<char>& ops) {
+    if (values.size() < 2) {
+        throw MalformedExpression();
+    }
+    double val2 = values.top(); values.pop();
+    double val1 = values.top(); values.pop();
+    char op = ops.top(); ops.pop();
+    values.push(applyOp(val1, val2, op));
+}
+
+double GameSession::evaluateExpression(const std::string& expr) {
+    std::stack<double> values;
+    std::stack<char> ops;
+    
+    for (size_t i = 0; i < expr.length(); i++) {
+        if (expr[i] == ' ')
+            continue;
+            
+        if (isdigit(expr[i])) {
+            double val = 0;
+            while (i < expr.length() && isdigit(expr[i])) {
+                val = val * 10 + (expr[i] - '0');
+                i++;
+            }
+            i--;
+            values.push(val);
+        }
+        else if (expr[i] == '(') {
+            ops.push(expr[i]);
+        }
+        else if (expr[i] == ')') {
+            while (!ops.empty() && ops.top() != '(') {
+                reduceTop(values, ops);
+            }
+            if (ops.empty()) {
+                throw MalformedExpression();
+            }
+            ops.pop();
+        }
+        else if (expr[i] == '+' || expr[i] == '-' || expr[i] == '*' || expr[i] == '/') {
+            while (!ops.empty() && precedence(ops.top()) >= precedence(expr[i])) {
+                reduceTop(values, ops);
+            }
+            ops.push(expr[i]);
+        }
+        else if (!isspace((unsigned char)expr[i])) {
+            throw MalformedExpression();
+        }
+    }
+    
+    while (!ops.empty()) {
+        if (ops.top() == '(') {
+            throw MalformedExpression();
+        }
+        reduceTop(values, ops);
+    }
+    
+    if (values.size() != 1) {
+        throw MalformedExpression();
+    }
+    return values.top();
+}
+
+int GameSession::precedence(char op) {
+    if (op == '+' || op == '-')
+        return 1;
+    if (op == '*' || op == '/')
+        return 2;
+    return 0;
+}
+
+double GameSession::applyOp(double a, double b, char op) {
+    switch (op) {
+        case '+': return a + b;
+        case '-': return a - b;
+        case '*': return a * b;
+        case '/': return b != 0 ? a / b : throw std::runtime_error("Division by zero");
+        default: throw std::runtime_error("Invalid operator");
+    }
+}
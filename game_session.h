@@ -0,0 +1,90 @@
+#ifndef GAME_SESSION_H
+#define GAME_SESSION_H
+
+#include <functional>
+#include <stack>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "solve24.h"
+
+enum class CheckResult {
+    Correct,
+    Wrong,
+    NotRunning,
+    NoCards,
+    Empty,
+    AlreadySolved
+};
+
+// Thrown by GameSession::evaluateExpression() for text that is not a valid
+// expression (stray characters, missing operands, unbalanced parentheses).
+// Arithmetic errors such as division by zero are plain runtime_errors.
+class MalformedExpression : public std::runtime_error {
+public:
+    MalformedExpression() : std::runtime_error("Malformed expression") {}
+};
+
+// The game rules (rounds, timer, scoring, combo, first try) without any GUI.
+// Time comes from an injectable clock in seconds and hands from an
+// injectable source, so the same session runs under FLTK or a simulator.
+class GameSession {
+public:
+    using Clock = std::function<double()>;
+    using HandSource = std::function<std::vector<int>()>;
+
+    GameSession();
+    GameSession(Clock clock, HandSource handSource);
+
+    static double steadyClock();
+    // `stats` gets the search of the returned hand only; `rejectedHands`
+    // counts the unsolvable hands drawn before it.
+    static std::vector<int> randomSolvableHand(SolveStats* stats = nullptr, int* rejectedHands = nullptr);
+
+    void setRoundTime(int seconds);
+    int roundTime() const { return selectedTime; }
+
+    // Deals a new hand. Returns true if this also began a new game.
+    bool startRound();
+    // Returns true once, when the running round has just timed out.
+    bool update();
+    CheckResult check(const std::string& answer);
+    void reset();
+
+    bool isRunning() const { return isTimerRunning; }
+    bool isRoundSolved() const { return roundSolved; }
+    int remainingTime() const;
+    const std::vector<int>& cards() const { return currentCards; }
+    int score() const { return currentScore; }
+    int combo() const { return comboCount; }
+    bool firstTry() const { return isFirstTry; }
+    int lastPoints() const { return lastRoundPoints; }
+
+    static bool validateAnswer(const std::vector<int>& cards, const std::string& answer);
+    // Whether the numbers in `answer` are exactly `cards`, each used once.
+    static bool usesExactlyCards(const std::vector<int>& cards, const std::string& answer);
+    static double evaluateExpression(const std::string& expr);
+
+private:
+    Clock clock;
+    HandSource handSource;
+
+    std::vector<int> currentCards;
+    int selectedTime;
+    int stoppedRemaining;
+    double roundStart;
+    bool isTimerRunning;
+    bool roundSolved;
+    int currentScore;
+    int comboCount;
+    bool isFirstTry;
+    int lastRoundPoints;
+
+    int calculateScore(int remaining) const;
+
+    static void reduceTop(std::stack<double>& values, std::stack<char>& ops);
+    static int precedence(char op);
+    static double applyOp(double a, double b, char op);
+};
+
+#endif
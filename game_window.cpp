@@ -6,23 +6,23 @@
 #include <fstream>
 #include <string>
 #include <sstream>
-#include <stack>
 #include <cctype>
 #include <algorithm>
+#include <chrono>
+#include <cstring>
 
 GameWindow::GameWindow(int w, int h, const char* title) 
-    : Fl_Double_Window(w, h, title) {
+    : Fl_Double_Window(w, h, title),
+      session(GameSession::steadyClock, [this]() { return dealHand(); }) {
     
     begin();
     
     
-    currentScore = 0;
     highScore = 0;
-    comboCount = 0;
-    isTimerRunning = false;
-    selectedTime = 60;  
-    remainingTime = selectedTime;
-    isFirstTry = true;
+    frameCount = 0;
+    lastFrameMs = 0;
+    totalFrameMs = 0;
+    nextTickDue = 0;
     
     
     Fl_Box* logo = new Fl_Box(w/2-150 , h/2-50, 300, 30, "24 CHALLENGE");
@@ -37,10 +37,8 @@ GameWindow::GameWindow(int w, int h, const char* title)
     int startY = 60;
     
     for (int i = 0; i < 4; i++) {
-        Fl_Box* card = new Fl_Box(startX + i * (cardWidth + 10), startY, 
-                                 cardWidth, cardHeight);
-        card->box(FL_UP_BOX);
-        card->color(FL_WHITE);
+        CardBox* card = new CardBox(startX + i * (cardWidth + 10), startY, 
+                                    cardWidth, cardHeight);
         cardBoxes.push_back(card);
     }
     
@@ -54,9 +52,9 @@ GameWindow::GameWindow(int w, int h, const char* title)
     scoreDisplay->box(FL_FLAT_BOX);
     scoreDisplay->labelsize(16);
     
-    highScoreDisplay = new Fl_Box(280, 10, 150, 30, "High Score: 0");
+    highScoreDisplay = new Fl_Box(280, 10, 150, 30, "Best: 0 | Top: 0");
     highScoreDisplay->box(FL_FLAT_BOX);
-    highScoreDisplay->labelsize(16);
+    highScoreDisplay->labelsize(14);
     
     comboDisplay = new Fl_Box(440, 10, 100, 30, "Combo: 0");
     comboDisplay->box(FL_FLAT_BOX);
@@ -71,9 +69,26 @@ GameWindow::GameWindow(int w, int h, const char* title)
     timeChoice->callback(cb_time_changed, this);
     
     
+    leaderboardDisplay = new Fl_Box(w - 200, 60, 180, 120, "");
+    leaderboardDisplay->box(FL_FLAT_BOX);
+    leaderboardDisplay->labelsize(12);
+    leaderboardDisplay->align(FL_ALIGN_TOP|FL_ALIGN_LEFT|FL_ALIGN_INSIDE);
+    
+    solutionsBrowser = new Fl_Browser(w - 200, 190, 180, 170);
+    solutionsBrowser->textsize(12);
+    
+    perfOverlay = new Fl_Box(10, 60, 200, 110, "");
+    perfOverlay->box(FL_BORDER_BOX);
+    perfOverlay->color(FL_LIGHT2);
+    perfOverlay->labelfont(FL_COURIER);
+    perfOverlay->labelsize(11);
+    perfOverlay->align(FL_ALIGN_TOP|FL_ALIGN_LEFT|FL_ALIGN_INSIDE);
+    perfOverlay->hide();
+    
+    
     int buttonWidth = 70;
     int buttonSpacing = 20;
-    int totalWidth = 4 * buttonWidth + 3 * buttonSpacing;
+    int totalWidth = 5 * buttonWidth + 4 * buttonSpacing;
     int buttonStartX = w/2 - totalWidth/2;
     
     startButton = new Fl_Button(buttonStartX, h - 70, buttonWidth, 30, "Start");
@@ -88,6 +103,10 @@ GameWindow::GameWindow(int w, int h, const char* title)
     fileButton = new Fl_Button(buttonStartX + 3 * (buttonWidth + buttonSpacing), h - 70, buttonWidth, 30, "File");
     fileButton->callback(cb_file, this);
     
+    moreButton = new Fl_Button(buttonStartX + 4 * (buttonWidth + buttonSpacing), h - 70, buttonWidth, 30, "More");
+    moreButton->callback(cb_more, this);
+    moreButton->deactivate();
+    
     
     answerInput = new Fl_Input(100, h - 120, w - 200, 30, "Answer:");
     answerInput->align(FL_ALIGN_LEFT);
@@ -101,6 +120,11 @@ GameWindow::GameWindow(int w, int h, const char* title)
     resultOutput = new Fl_Output(100, h - 190, w - 200, 30, "Result:");
     resultOutput->align(FL_ALIGN_LEFT);
     
+    playerInput = new Fl_Input(100, h - 230, 150, 30, "Player:");
+    playerInput->align(FL_ALIGN_LEFT);
+    playerInput->value("Guest");
+    playerInput->callback(cb_player_changed, this);
+    
     end();
     
     
@@ -115,7 +139,10 @@ void GameWindow::cb_start(Fl_Widget*, void* v) {
 }
 
 void GameWindow::cb_check(Fl_Widget*, void* v) {
-    ((GameWindow*)v)->check();
+    GameWindow* window = (GameWindow*)v;
+    double begin = GameSession::steadyClock();
+    window->check();
+    window->perf.checkMs.add((GameSession::steadyClock() - begin) * 1000);
 }
 
 void GameWindow::cb_reset(Fl_Widget*, void* v) {
@@ -126,98 +153,76 @@ void GameWindow::cb_file(Fl_Widget*, void* v) {
     ((GameWindow*)v)->processFile();
 }
 
+void GameWindow::cb_more(Fl_Widget*, void* v) {
+    ((GameWindow*)v)->showMoreSolutions();
+}
+
+void GameWindow::cb_solutions_idle(void* v) {
+    ((GameWindow*)v)->stepSolutions();
+}
+
 void GameWindow::cb_timer(void* v) {
     GameWindow* window = (GameWindow*)v;
     window->updateTimer();
 }
 
 void GameWindow::startTimer() {
-    isTimerRunning = true;
+    Fl::remove_timeout(cb_timer, this);
     Fl::add_timeout(1.0, cb_timer, this);  
+    nextTickDue = GameSession::steadyClock() + 1.0;
 }
 
 void GameWindow::stopTimer() {
-    isTimerRunning = false;
     Fl::remove_timeout(cb_timer, this);
 }
 
-void GameWindow::resetTimer() {
-    stopTimer();
-    remainingTime = selectedTime;
-    isFirstTry = true;
-    updateTimerDisplay();  
-}
-
 void GameWindow::updateTimer() {
-    if (isTimerRunning) {
-        remainingTime--;
-        if (remainingTime <= 0) {
-            stopTimer();
-            
-            
-            std::vector<double> nums(currentCards.begin(), currentCards.end());
-            std::vector<std::string> exprs;
-            for (int num : currentCards) {
-                exprs.push_back(std::to_string(num));
-            }
-            std::string solution;
-            if (solve24(nums, exprs, solution)) {
-                std::string message = "Time's up! A solution is: " + solution + " = 24";
-                resultOutput->value(message.c_str());
-            } else {
-                resultOutput->value("Time's up!");
-            }
-            
-            
-            checkButton->deactivate();
-            startButton->activate();
-            
-            
-            updateTimerDisplay();
-            return;
-        }
+    if (!session.isRunning()) {
+        return;
+    }
+    
+    double now = GameSession::steadyClock();
+    perf.tickJitterMs.add((now - nextTickDue) * 1000);
+    
+    if (session.update()) {
         
         
-        updateTimerDisplay();
+        const std::vector<int>& cards = session.cards();
+        std::vector<double> nums(cards.begin(), cards.end());
+        std::vector<std::string> exprs;
+        for (int num : cards) {
+            exprs.push_back(std::to_string(num));
+        }
+        std::string solution;
+        SolveLimits limits;
+        limits.deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(50);
+        if (solve24(nums, exprs, solution, SolveOptions(), limits) == SolveResult::Solved) {
+            std::string message = "Time's up! A solution is: " + solution + " = 24";
+            resultOutput->value(message.c_str());
+        } else {
+            resultOutput->value("Time's up!");
+        }
         
         
-        if (remainingTime <= 10) {
-            timerDisplay->labelcolor(FL_RED);
-        }
+        checkButton->deactivate();
+        startButton->activate();
+        moreButton->activate();
+        
         
-        Fl::add_timeout(1.0, cb_timer, this);
+        updateTimerDisplay();
+        return;
     }
-}
-
-void GameWindow::calculateScore() {
-    int baseScore = 100;
-    double timeMultiplier;
-    
-    
-    if (remainingTime >= 45) timeMultiplier = 1.5;
-    else if (remainingTime >= 30) timeMultiplier = 1.2;
-    else if (remainingTime >= 15) timeMultiplier = 1.0;
-    else timeMultiplier = 0.8;
     
     
-    int finalScore = baseScore * timeMultiplier;
+    updateTimerDisplay();
     
     
-    if (isFirstTry) {
-        finalScore += 50;
+    if (session.remainingTime() <= 10) {
+        timerDisplay->labelcolor(FL_RED);
     }
     
-    
-    finalScore += comboCount * 10;
-    
-    
-    currentScore += finalScore;
-    
-    
-    if (currentScore > highScore) {
-        highScore = currentScore;
-        saveGameData();
-    }
+    Fl::add_timeout(1.0, cb_timer, this);
+    nextTickDue = now + 1.0;
 }
 
 void GameWindow::updateDisplays() {
@@ -227,228 +232,208 @@ void GameWindow::updateDisplays() {
     static char comboStr[32];
     
     
-    snprintf(scoreStr, sizeof(scoreStr), "Score: %d", currentScore);
-    snprintf(highScoreStr, sizeof(highScoreStr), "High Score: %d", highScore);
-    snprintf(comboStr, sizeof(comboStr), "Combo: %d", comboCount);
+    snprintf(scoreStr, sizeof(scoreStr), "Score: %d", session.score());
+    snprintf(highScoreStr, sizeof(highScoreStr), "Best: %d | Top: %d", highScore, leaderboard.globalBest());
+    snprintf(comboStr, sizeof(comboStr), "Combo: %d", session.combo());
     
     
-    scoreDisplay->copy_label(scoreStr);
-    highScoreDisplay->copy_label(highScoreStr);
-    comboDisplay->copy_label(comboStr);
+    setHudLabel(scoreDisplay, scoreStr);
+    setHudLabel(highScoreDisplay, highScoreStr);
+    setHudLabel(comboDisplay, comboStr);
+}
+
+void GameWindow::setHudLabel(Fl_Box* box, const char* text) {
     
-    scoreDisplay->redraw();
-    highScoreDisplay->redraw();
-    comboDisplay->redraw();
+    const char* current = box->label();
+    if (current && std::strcmp(current, text) == 0) {
+        return;
+    }
+    box->copy_label(text);
+    box->redraw();
 }
 
-void GameWindow::saveGameData() {
-    std::ofstream file("game_data.txt");
-    if (file.is_open()) {
-        file << highScore << std::endl;
-        file.close();
+void GameWindow::flush() {
+    auto begin = std::chrono::steady_clock::now();
+    Fl_Double_Window::flush();
+    lastFrameMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+    totalFrameMs += lastFrameMs;
+    frameCount++;
+    perf.redrawMs.add(lastFrameMs);
+}
+
+int GameWindow::handle(int event) {
+    if (event == FL_SHORTCUT || event == FL_KEYDOWN) {
+        if (Fl::event_key() == FL_F + 1) {
+            togglePerfOverlay();
+            return 1;
+        }
+        if (Fl::event_key() == FL_F + 2) {
+            togglePerfLog();
+            return 1;
+        }
     }
+    return Fl_Double_Window::handle(event);
 }
 
-void GameWindow::loadGameData() {
-    std::ifstream file("game_data.txt");
-    if (file.is_open()) {
-        file >> highScore;
-        file.close();
-        updateDisplays();
+std::vector<int> GameWindow::dealHand() {
+    SolveStats stats;
+    int rejected = 0;
+    double begin = GameSession::steadyClock();
+    std::vector<int> hand = GameSession::randomSolvableHand(&stats, &rejected);
+    perf.solveMs.add((GameSession::steadyClock() - begin) * 1000);
+    perf.solveNodes.add((double)stats.nodes);
+    perf.rejectedHands.add(rejected);
+    return hand;
+}
+
+void GameWindow::togglePerfOverlay() {
+    if (perfOverlay->visible()) {
+        perfOverlay->hide();
+    } else {
+        perfOverlay->show();
     }
+    refreshPerf();
 }
 
-void GameWindow::start() {
-    
-    if (!isTimerRunning) {
-        currentScore = 0;
-        comboCount = 0;
-        updateDisplays();
+void GameWindow::togglePerfLog() {
+    if (perfLog.is_open()) {
+        perfLog.close();
+    } else {
+        perfLog.open("perf_log.txt", std::ios::app);
+        perfLog << "# time solve_ms solve_nodes check_ms tick_jitter_ms redraw_ms rejected_hands" << std::endl;
     }
-    
-    resetTimer();
-    currentCards.clear();
-    
-    std::vector<int> tempCards;
-    bool hasSolution = false;
-    
-    while (!hasSolution) {
-        tempCards.clear();
-        for (int i = 0; i < 4; i++) {
-            int card = rand() % 13 + 1;
-            tempCards.push_back(card);
-        }
-        
-        std::vector<double> nums(tempCards.begin(), tempCards.end());
-        std::vector<std::string> exprs;
-        for (int num : tempCards) {
-            exprs.push_back(std::to_string(num));
-        }
-        
-        std::string solution;
-        if (solve24(nums, exprs, solution)) {
-            hasSolution = true;
-            currentCards = tempCards;
-        }
+    refreshPerf();
+}
+
+void GameWindow::cb_perf_refresh(void* v) {
+    ((GameWindow*)v)->refreshPerf();
+}
+
+void GameWindow::refreshPerf() {
+    Fl::remove_timeout(cb_perf_refresh, this);
+    if (!perfOverlay->visible() && !perfLog.is_open()) {
+        return;
     }
     
-    
-    for (int i = 0; i < 4; i++) {
-        std::string cardText;
-        int card = currentCards[i];
-        if (card == 1) cardText = "A";
-        else if (card == 11) cardText = "J";
-        else if (card == 12) cardText = "Q";
-        else if (card == 13) cardText = "K";
-        else cardText = std::to_string(card);
-        
-        cardBoxes[i]->copy_label(cardText.c_str());
+    if (perfOverlay->visible()) {
+        static char overlayStr[256];
+        snprintf(overlayStr, sizeof(overlayStr),
+                 "deal   %7.2f ms avg %6.2f\n"
+                 "nodes  %7.0f    avg %6.0f\n"
+                 "reject %7.0f    avg %6.2f\n"
+                 "check  %7.3f ms max %6.3f\n"
+                 "tick   %+7.1f ms max %+6.1f\n"
+                 "redraw %7.2f ms max %6.2f\n"
+                 "frames %d%s",
+                 perf.solveMs.last(), perf.solveMs.mean(),
+                 perf.solveNodes.last(), perf.solveNodes.mean(),
+                 perf.rejectedHands.last(), perf.rejectedHands.mean(),
+                 perf.checkMs.last(), perf.checkMs.max(),
+                 perf.tickJitterMs.last(), perf.tickJitterMs.max(),
+                 perf.redrawMs.last(), perf.redrawMs.max(),
+                 frameCount, perfLog.is_open() ? "  [log]" : "");
+        setHudLabel(perfOverlay, overlayStr);
     }
     
+    if (perfLog.is_open()) {
+        perfLog << std::fixed << GameSession::steadyClock() << " "
+                << perf.solveMs.last() << " " << perf.solveNodes.last() << " "
+                << perf.checkMs.last() << " " << perf.tickJitterMs.last() << " "
+                << perf.redrawMs.last() << " " << perf.rejectedHands.last() << std::endl;
+    }
     
-    answerInput->value("");
-    resultOutput->value("");
-    checkButton->activate();  
-    startButton->deactivate();  
-    timerDisplay->labelcolor(FL_BLACK);  
-    
-    startTimer();
-    redraw();
+    Fl::add_timeout(0.5, cb_perf_refresh, this);
 }
 
-bool GameWindow::validateAnswer(const std::string& answer) {
-    
-    std::vector<int> usedNumbers;
-    std::string num;
-    for (size_t i = 0; i < answer.length(); i++) {
-        if (isdigit(answer[i])) {
-            num += answer[i];
-            
-            if (i + 1 == answer.length() || !isdigit(answer[i + 1])) {
-                usedNumbers.push_back(std::stoi(num));
-                num.clear();
-            }
-        }
+void GameWindow::updateLeaderboardDisplay() {
+    std::string text = "Leaderboard";
+    int rank = 1;
+    for (const LeaderboardEntry& entry : leaderboard.top(5)) {
+        text += "\n" + std::to_string(rank++) + ". " + entry.name + "  " + std::to_string(entry.best);
     }
-    
-    
-    if (usedNumbers.size() != currentCards.size()) {
-        return false;
+    setHudLabel(leaderboardDisplay, text.c_str());
+}
+
+std::string GameWindow::playerName() const {
+    std::string name = playerInput->value();
+    name.erase(0, name.find_first_not_of(' '));
+    name.erase(name.find_last_not_of(' ') + 1);
+    return name.empty() ? "Guest" : name;
+}
+
+void GameWindow::saveGameData() {
+    leaderboard.flush();
+    updateLeaderboardDisplay();
+}
+
+void GameWindow::loadGameData() {
+    if (!leaderboard.open("leaderboard.dat")) {
+        return;
     }
     
     
-    std::vector<int> availableCards = currentCards;
-    
-    
-    for (int num : usedNumbers) {
-        auto it = std::find(availableCards.begin(), availableCards.end(), num);
-        if (it == availableCards.end()) {
-            return false;  
+    if (leaderboard.playerCount() == 0) {
+        std::ifstream file("game_data.txt");
+        int legacyHighScore = 0;
+        if (file >> legacyHighScore && legacyHighScore > 0) {
+            leaderboard.recordScore("Guest", legacyHighScore);
         }
-        
-        availableCards.erase(it);
     }
     
-    
-    try {
-        double result = evaluateExpression(answer);
-        return fabs(result - 24.0) < 1e-6;  
-    } catch (const std::runtime_error& e) {
-        return false;
-    }
+    highScore = leaderboard.playerBest(playerName());
+    updateDisplays();
+    updateLeaderboardDisplay();
 }
 
-double GameWindow::evaluateExpression(const std::string& expr) {
-    std::stack<double> values;
-    std::stack<char> ops;
+void GameWindow::start() {
     
-    for (size_t i = 0; i < expr.length(); i++) {
-        if (expr[i] == ' ')
-            continue;
-            
-        if (isdigit(expr[i])) {
-            double val = 0;
-            while (i < expr.length() && isdigit(expr[i])) {
-                val = val * 10 + (expr[i] - '0');
-                i++;
-            }
-            i--;
-            values.push(val);
-        }
-        else if (expr[i] == '(') {
-            ops.push(expr[i]);
-        }
-        else if (expr[i] == ')') {
-            while (!ops.empty() && ops.top() != '(') {
-                double val2 = values.top(); values.pop();
-                double val1 = values.top(); values.pop();
-                char op = ops.top(); ops.pop();
-                values.push(applyOp(val1, val2, op));
-            }
-            if (!ops.empty())
-                ops.pop();  
-        }
-        else if (expr[i] == '+' || expr[i] == '-' || expr[i] == '*' || expr[i] == '/') {
-            while (!ops.empty() && precedence(ops.top()) >= precedence(expr[i])) {
-                double val2 = values.top(); values.pop();
-                double val1 = values.top(); values.pop();
-                char op = ops.top(); ops.pop();
-                values.push(applyOp(val1, val2, op));
-            }
-            ops.push(expr[i]);
-        }
+    if (session.startRound()) {
+        leaderboard.recordGame(playerName());
     }
+    updateDisplays();
+    updateTimerDisplay();
     
-    while (!ops.empty()) {
-        double val2 = values.top(); values.pop();
-        double val1 = values.top(); values.pop();
-        char op = ops.top(); ops.pop();
-        values.push(applyOp(val1, val2, op));
-    }
     
-    return values.top();
-}
-
-int GameWindow::precedence(char op) {
-    if (op == '+' || op == '-')
-        return 1;
-    if (op == '*' || op == '/')
-        return 2;
-    return 0;
-}
-
-double GameWindow::applyOp(double a, double b, char op) {
-    switch (op) {
-        case '+': return a + b;
-        case '-': return a - b;
-        case '*': return a * b;
-        case '/': return b != 0 ? a / b : throw std::runtime_error("Division by zero");
-        default: throw std::runtime_error("Invalid operator");
+    for (int i = 0; i < 4; i++) {
+        cardBoxes[i]->face(session.cards()[i]);
     }
+    
+    
+    answerInput->value("");
+    resultOutput->value("");
+    stopSolutions();
+    solutionsBrowser->clear();
+    checkButton->activate();  
+    startButton->deactivate();  
+    moreButton->deactivate();
+    timerDisplay->labelcolor(FL_BLACK);  
+    timerDisplay->redraw();
+    
+    startTimer();
 }
 
 void GameWindow::check() {
-    if (!isTimerRunning) {
-        resultOutput->value("Please start the game first or time's up!");
-        return;
-    }
-    
-    if (currentCards.empty()) {
-        resultOutput->value("Please start the game first!");
-        return;
-    }
-    
     std::string playerAnswer = answerInput->value();
-    if (playerAnswer.empty()) {
-        resultOutput->value("Please enter your answer!");
-        return;
-    }
     
-    try {
-        if (validateAnswer(playerAnswer)) {
+    switch (session.check(playerAnswer)) {
+        case CheckResult::NotRunning:
+            resultOutput->value("Please start the game first or time's up!");
+            return;
+        case CheckResult::NoCards:
+            resultOutput->value("Please start the game first!");
+            return;
+        case CheckResult::Empty:
+            resultOutput->value("Please enter your answer!");
+            return;
+        case CheckResult::AlreadySolved:
+            resultOutput->value("Correct! Next round is coming...");
+            return;
+        case CheckResult::Correct:
             resultOutput->value("Correct!");
-            calculateScore();
-            comboCount++;
+            if (session.score() > highScore) {
+                highScore = leaderboard.recordScore(playerName(), session.score());
+                saveGameData();
+            }
             updateDisplays();
             
             
@@ -456,46 +441,93 @@ void GameWindow::check() {
                 GameWindow* window = (GameWindow*)v;
                 window->start();
             }, this);
-        } else {
+            return;
+        case CheckResult::Wrong:
             resultOutput->value("Wrong answer! Try again.");
-            comboCount = 0;
-            
-            currentScore = std::max(0, currentScore - 50);
-            isFirstTry = false;
             updateDisplays();
-        }
-    } catch (const std::runtime_error& e) {
-        resultOutput->value(e.what());  
-        comboCount = 0;
-        
-        currentScore = std::max(0, currentScore - 50);
-        isFirstTry = false;
-        updateDisplays();
+            return;
     }
 }
 
 void GameWindow::reset() {
     stopTimer();
-    currentCards.clear();
+    session.reset();
     for (auto box : cardBoxes) {
-        box->label("");
+        box->face(0);
     }
     answerInput->value("");  
     resultOutput->value("");
-    currentScore = 0;
-    comboCount = 0;
-    remainingTime = selectedTime;
-    isFirstTry = true;
     
     
+    stopSolutions();
+    solutionsBrowser->clear();
     startButton->activate();
     checkButton->deactivate();
+    moreButton->deactivate();
     
     
     timerDisplay->labelcolor(FL_BLACK);
+    timerDisplay->redraw();
     updateTimerDisplay();
     updateDisplays();
-    redraw();
+}
+
+void GameWindow::showMoreSolutions() {
+    const std::vector<int>& cards = session.cards();
+    if (cards.empty()) {
+        return;
+    }
+    
+    stopSolutions();
+    solutionsBrowser->clear();
+    shownSolutions.clear();
+    
+    std::vector<double> nums(cards.begin(), cards.end());
+    std::vector<std::string> exprs;
+    for (int num : cards) {
+        exprs.push_back(std::to_string(num));
+    }
+    solutionGenerator.reset(new SolutionGenerator(nums, exprs));
+    
+    
+    stepSolutions();
+    if (solutionGenerator) {
+        Fl::add_idle(cb_solutions_idle, this);
+    }
+}
+
+void GameWindow::stepSolutions() {
+    
+    const long long sliceNodes = 300;
+    
+    if (!solutionGenerator) {
+        return;
+    }
+    
+    long long startNodes = solutionGenerator->nodes();
+    long long budget = sliceNodes;
+    std::string solution;
+    SolutionGenerator::Status status;
+    while ((status = solutionGenerator->next(solution, budget)) == SolutionGenerator::Status::Found) {
+        if (shownSolutions.insert(solution).second) {
+            solutionsBrowser->add((solution + " = 24").c_str());
+        }
+        budget = sliceNodes - (solutionGenerator->nodes() - startNodes);
+        if (budget <= 0) {
+            return;
+        }
+    }
+    
+    if (status == SolutionGenerator::Status::Exhausted) {
+        std::string summary = "Total: " + std::to_string(shownSolutions.size());
+        solutionsBrowser->add(summary.c_str());
+        stopSolutions();
+    }
+}
+
+void GameWindow::stopSolutions() {
+    Fl::remove_idle(cb_solutions_idle, this);
+    solutionGenerator.reset();
 }
 
 void GameWindow::processFile() {
@@ -579,6 +611,8 @@ bool GameWindow::processLine(const std::string& line, std::string& result, std::
 
 GameWindow::~GameWindow() {
     stopTimer();
+    stopSolutions();
+    Fl::remove_timeout(cb_perf_refresh, this);
     saveGameData();
     
     for (auto box : cardBoxes) {
@@ -589,19 +623,24 @@ GameWindow::~GameWindow() {
     delete resetButton;
     delete resultOutput;
     delete fileButton;
+    delete moreButton;
+    delete solutionsBrowser;
+    delete perfOverlay;
     delete timerDisplay;
     delete scoreDisplay;
     delete highScoreDisplay;
     delete comboDisplay;
     delete timeChoice;
     delete answerInput;
+    delete playerInput;
+    delete leaderboardDisplay;
+    CardBox::clearCache();
 }
 
 void GameWindow::updateTimerDisplay() {
     static char timeStr[32];
-    snprintf(timeStr, sizeof(timeStr), "Time: %d", remainingTime);
-    timerDisplay->copy_label(timeStr);
-    timerDisplay->redraw();
+    snprintf(timeStr, sizeof(timeStr), "Time: %d", session.remainingTime());
+    setHudLabel(timerDisplay, timeStr);
 }
 
 void GameWindow::cb_time_changed(Fl_Widget* w, void* v) {
@@ -610,10 +649,15 @@ void GameWindow::cb_time_changed(Fl_Widget* w, void* v) {
     int selected = choice->value();
     
     switch(selected) {
-        case 0: window->selectedTime = 30; break;
-        case 1: window->selectedTime = 60; break;
-        case 2: window->selectedTime = 120; break;
+        case 0: window->session.setRoundTime(30); break;
+        case 1: window->session.setRoundTime(60); break;
+        case 2: window->session.setRoundTime(120); break;
     }
-    window->remainingTime = window->selectedTime;
     window->updateTimerDisplay();
+}
+
+void GameWindow::cb_player_changed(Fl_Widget*, void* v) {
+    GameWindow* window = (GameWindow*)v;
+    window->highScore = window->leaderboard.playerBest(window->playerName());
+    window->updateDisplays();
 } 
\ No newline at end of file
@@ -8,26 +8,35 @@
 #include <FL/Fl_Output.H>
 #include <FL/Fl_Input.H>
 #include <FL/Fl_Choice.H>
+#include <FL/Fl_Browser.H>
 #include <vector>
 #include <string>
 #include <fstream>
 #include <sstream>
 #include <cmath>
+#include <memory>
+#include <set>
 #include "solve24.h"
+#include "leaderboard.h"
+#include "card_box.h"
+#include "game_session.h"
+#include "perf_stats.h"
 
 class GameWindow : public Fl_Double_Window {
 private:
     
-    std::vector<Fl_Box*> cardBoxes;
+    std::vector<CardBox*> cardBoxes;
     
     
     Fl_Button* startButton;
     Fl_Button* checkButton;
     Fl_Button* resetButton;
     Fl_Button* fileButton;
+    Fl_Button* moreButton;
     
     
     Fl_Input* answerInput;
+    Fl_Input* playerInput;
     Fl_Output* resultOutput;
     
     
@@ -35,55 +44,75 @@ private:
     Fl_Box* scoreDisplay;
     Fl_Box* highScoreDisplay;
     Fl_Box* comboDisplay;
+    Fl_Box* leaderboardDisplay;
+    Fl_Browser* solutionsBrowser;
+    Fl_Box* perfOverlay;
     Fl_Choice* timeChoice;
     
     
-    std::vector<int> currentCards;
+    GameSession session;
+    int highScore;
+    Leaderboard leaderboard;
     
     
-    int remainingTime;
-    int selectedTime;
-    bool isTimerRunning;
-    int currentScore;
-    int highScore;
-    int comboCount;
-    bool isFirstTry;
+    std::unique_ptr<SolutionGenerator> solutionGenerator;
+    std::set<std::string> shownSolutions;
+    
+    
+    int frameCount;
+    double lastFrameMs;
+    double totalFrameMs;
+    PerfCounters perf;
+    double nextTickDue;
+    std::ofstream perfLog;
     
     
     static void cb_start(Fl_Widget*, void*);
     static void cb_check(Fl_Widget*, void*);
     static void cb_reset(Fl_Widget*, void*);
     static void cb_file(Fl_Widget*, void*);
+    static void cb_more(Fl_Widget*, void*);
     static void cb_timer(void* v);
+    static void cb_solutions_idle(void* v);
+    static void cb_perf_refresh(void* v);
     static void cb_time_changed(Fl_Widget*, void*);
+    static void cb_player_changed(Fl_Widget*, void*);
     
     
     void start();
     void check();
     void reset();
     void processFile();
+    void showMoreSolutions();
+    void stepSolutions();
+    void stopSolutions();
+    std::vector<int> dealHand();
+    void togglePerfOverlay();
+    void togglePerfLog();
+    void refreshPerf();
     bool processLine(const std::string& line, std::string& result, std::string& solution);
     
     
     void startTimer();
     void stopTimer();
-    void resetTimer();
     void updateTimer();
     void updateTimerDisplay();
-    void calculateScore();
     void updateDisplays();
+    void updateLeaderboardDisplay();
+    void setHudLabel(Fl_Box* box, const char* text);
+    std::string playerName() const;
     void saveGameData();
     void loadGameData();
-    
-    
-    bool validateAnswer(const std::string& answer);
-    double evaluateExpression(const std::string& expr);
-    int precedence(char op);
-    double applyOp(double a, double b, char op);
 
 public:
     GameWindow(int w, int h, const char* title);
     ~GameWindow();
+    
+    void flush() override;
+    int handle(int event) override;
+    int frames() const { return frameCount; }
+    double lastFrameTime() const { return lastFrameMs; }
+    double averageFrameTime() const { return frameCount ? totalFrameMs / frameCount : 0; }
 };
 
 #endif 
\ No newline at end of file
@@ -0,0 +1,334 @@
+#include "leaderboard.h"
+#include <cstring>
+#include <algorithm>
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+const char MAGIC[8] = {'2', '4', 'B', 'O', 'A', 'R', 'D', '\0'};
+const uint32_t VERSION = 1;
+const uint32_t INITIAL_CAPACITY = 64;
+
+}
+
+struct Leaderboard::Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t count;
+    uint32_t capacity;
+    uint32_t topCount;
+    uint32_t top[TOP_K];
+};
+
+struct Leaderboard::Record {
+    char name[NAME_SIZE];
+    int32_t best;
+    int32_t games;
+};
+
+static std::string recordKey(const std::string& player) {
+    return player.substr(0, Leaderboard::NAME_SIZE - 1);
+}
+
+Leaderboard::Leaderboard() : base(nullptr), mappedSize(0) {
+#ifdef _WIN32
+    fileHandle = nullptr;
+    mappingHandle = nullptr;
+#else
+    fd = -1;
+#endif
+}
+
+Leaderboard::~Leaderboard() {
+    close();
+}
+
+bool Leaderboard::open(const std::string& filePath) {
+    close();
+    path = filePath;
+
+    size_t existing = 0;
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, NULL,
+                              OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    fileHandle = file;
+    LARGE_INTEGER fileSize;
+    if (GetFileSizeEx(file, &fileSize)) {
+        existing = (size_t)fileSize.QuadPart;
+    }
+#else
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == 0) {
+        existing = (size_t)st.st_size;
+    }
+#endif
+
+    bool fresh = existing < sizeof(Header);
+    size_t size = fresh ? sizeof(Header) + INITIAL_CAPACITY * sizeof(Record) : existing;
+    if (!map(size)) {
+        close();
+        return false;
+    }
+
+    Header* h = header();
+    if (fresh) {
+        std::memset(base, 0, size);
+        std::memcpy(h->magic, MAGIC, sizeof(MAGIC));
+        h->version = VERSION;
+        h->capacity = INITIAL_CAPACITY;
+        return true;
+    }
+
+    if (std::memcmp(h->magic, MAGIC, sizeof(MAGIC)) != 0 || h->version != VERSION ||
+        h->capacity == 0 || h->count > h->capacity || h->topCount > TOP_K ||
+        size < sizeof(Header) + h->capacity * sizeof(Record)) {
+        close();
+        return false;
+    }
+
+    // A damaged top index would point past the records; rebuild it instead
+    // of losing the whole board.
+    for (uint32_t t = 0; t < h->topCount; t++) {
+        if (h->top[t] >= h->count) {
+            rebuildTop();
+            break;
+        }
+    }
+    return true;
+}
+
+void Leaderboard::close() {
+    if (base) {
+        flush();
+    }
+    unmap();
+#ifdef _WIN32
+    if (fileHandle) {
+        CloseHandle((HANDLE)fileHandle);
+        fileHandle = nullptr;
+    }
+#else
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+#endif
+}
+
+void Leaderboard::flush() {
+    if (!base) return;
+#ifdef _WIN32
+    FlushViewOfFile(base, mappedSize);
+#else
+    msync(base, mappedSize, MS_SYNC);
+#endif
+}
+
+bool Leaderboard::map(size_t size) {
+#ifdef _WIN32
+    HANDLE mapping = CreateFileMappingA((HANDLE)fileHandle, NULL, PAGE_READWRITE,
+                                       (DWORD)((unsigned long long)size >> 32), (DWORD)size, NULL);
+    if (!mapping) {
+        return false;
+    }
+    void* view = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+    if (!view) {
+        CloseHandle(mapping);
+        return false;
+    }
+    mappingHandle = mapping;
+    base = (char*)view;
+#else
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        return false;
+    }
+    if ((size_t)st.st_size < size && ftruncate(fd, (off_t)size) != 0) {
+        return false;
+    }
+    void* view = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (view == MAP_FAILED) {
+        return false;
+    }
+    base = (char*)view;
+#endif
+    mappedSize = size;
+    return true;
+}
+
+void Leaderboard::unmap() {
+    if (!base) return;
+#ifdef _WIN32
+    UnmapViewOfFile(base);
+    CloseHandle((HANDLE)mappingHandle);
+    mappingHandle = nullptr;
+#else
+    munmap(base, mappedSize);
+#endif
+    base = nullptr;
+    mappedSize = 0;
+}
+
+bool Leaderboard::grow() {
+    uint32_t capacity = header()->capacity * 2;
+    flush();
+    unmap();
+    if (!map(sizeof(Header) + capacity * sizeof(Record))) {
+        return false;
+    }
+    header()->capacity = capacity;
+    return true;
+}
+
+Leaderboard::Header* Leaderboard::header() const {
+    return (Header*)base;
+}
+
+Leaderboard::Record* Leaderboard::records() const {
+    return (Record*)(base + sizeof(Header));
+}
+
+int Leaderboard::find(const std::string& name, bool& found) const {
+    int lo = 0;
+    int hi = (int)header()->count;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (std::strncmp(records()[mid].name, name.c_str(), NAME_SIZE) < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    found = lo < (int)header()->count && std::strncmp(records()[lo].name, name.c_str(), NAME_SIZE) == 0;
+    return lo;
+}
+
+int Leaderboard::findOrInsert(const std::string& player) {
+    std::string key = recordKey(player);
+    bool found;
+    int index = find(key, found);
+    if (found) {
+        return index;
+    }
+
+    if (header()->count == header()->capacity && !grow()) {
+        return -1;
+    }
+
+    // New players shift the records after them; score updates never do.
+    Header* h = header();
+    Record* r = records();
+    std::memmove(r + index + 1, r + index, (h->count - index) * sizeof(Record));
+    std::memset(&r[index], 0, sizeof(Record));
+    std::memcpy(r[index].name, key.c_str(), key.size());
+    h->count++;
+
+    for (uint32_t t = 0; t < h->topCount; t++) {
+        if (h->top[t] >= (uint32_t)index) {
+            h->top[t]++;
+        }
+    }
+    return index;
+}
+
+void Leaderboard::updateTop(int index) {
+    Header* h = header();
+    Record* r = records();
+
+    int pos = -1;
+    for (uint32_t t = 0; t < h->topCount; t++) {
+        if (h->top[t] == (uint32_t)index) {
+            pos = (int)t;
+        }
+    }
+
+    if (pos < 0) {
+        if (h->topCount < TOP_K) {
+            pos = (int)h->topCount++;
+        } else if (r[h->top[TOP_K - 1]].best < r[index].best) {
+            pos = TOP_K - 1;
+        } else {
+            return;
+        }
+        h->top[pos] = (uint32_t)index;
+    }
+
+    while (pos > 0 && r[h->top[pos - 1]].best < r[h->top[pos]].best) {
+        std::swap(h->top[pos - 1], h->top[pos]);
+        pos--;
+    }
+}
+
+void Leaderboard::rebuildTop() {
+    Header* h = header();
+    h->topCount = 0;
+    for (uint32_t i = 0; i < h->count; i++) {
+        if (records()[i].best > 0) {
+            updateTop((int)i);
+        }
+    }
+}
+
+int Leaderboard::playerCount() const {
+    return base ? (int)header()->count : 0;
+}
+
+int Leaderboard::playerBest(const std::string& player) const {
+    if (!base) return 0;
+    bool found;
+    int index = find(recordKey(player), found);
+    return found ? records()[index].best : 0;
+}
+
+int Leaderboard::globalBest() const {
+    if (!base || header()->topCount == 0) return 0;
+    return records()[header()->top[0]].best;
+}
+
+int Leaderboard::recordScore(const std::string& player, int score) {
+    if (!base) return score;
+    int index = findOrInsert(player);
+    if (index < 0) return score;
+
+    Record& record = records()[index];
+    if (score > record.best) {
+        record.best = score;
+        updateTop(index);
+    }
+    return record.best;
+}
+
+void Leaderboard::recordGame(const std::string& player) {
+    if (!base) return;
+    int index = findOrInsert(player);
+    if (index >= 0) {
+        records()[index].games++;
+    }
+}
+
+std::vector<LeaderboardEntry> Leaderboard::top(int k) const {
+    std::vector<LeaderboardEntry> entries;
+    if (!base) return entries;
+
+    int n = std::min(k, (int)header()->topCount);
+    for (int t = 0; t < n; t++) {
+        const Record& record = records()[header()->top[t]];
+        entries.push_back({std::string(record.name, strnlen(record.name, NAME_SIZE)), record.best, record.games});
+    }
+    return entries;
+}
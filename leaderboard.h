@@ -0,0 +1,66 @@
+#ifndef LEADERBOARD_H
+#define LEADERBOARD_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct LeaderboardEntry {
+    std::string name;
+    int best;
+    int games;
+};
+
+// Player profiles kept in a memory-mapped binary file. Records are stored
+// sorted by name so lookups and updates are a binary search, and the header
+// keeps the indices of the top TOP_K players so the board reads in O(K).
+class Leaderboard {
+public:
+    static const int TOP_K = 10;
+    static const int NAME_SIZE = 32;
+
+    Leaderboard();
+    ~Leaderboard();
+
+    bool open(const std::string& path);
+    void close();
+    void flush();
+    bool isOpen() const { return base != nullptr; }
+
+    int playerCount() const;
+    int playerBest(const std::string& player) const;
+    int globalBest() const;
+
+    // Returns the player's best score after the update.
+    int recordScore(const std::string& player, int score);
+    void recordGame(const std::string& player);
+
+    std::vector<LeaderboardEntry> top(int k) const;
+
+private:
+    struct Header;
+    struct Record;
+
+    std::string path;
+    char* base;
+    size_t mappedSize;
+#ifdef _WIN32
+    void* fileHandle;
+    void* mappingHandle;
+#else
+    int fd;
+#endif
+
+    Header* header() const;
+    Record* records() const;
+
+    bool map(size_t size);
+    void unmap();
+    bool grow();
+    int find(const std::string& name, bool& found) const;
+    int findOrInsert(const std::string& player);
+    void updateTop(int index);
+    void rebuildTop();
+};
+
+#endif
@@ -1,6 +1,64 @@
 #include "game_window.h"
+#include "simulator.h"
+#include "verifier.h"
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+int main(int argc, char** argv) {
+    if (argc > 1 && std::strcmp(argv[1], "--batch") == 0) {
+        BatchOptions options;
+        for (int i = 2; i + 1 < argc; i += 2) {
+            if (std::strcmp(argv[i], "--targets") == 0) {
+                options.targetLimit = std::atoi(argv[i + 1]);
+            } else if (std::strcmp(argv[i], "--input") == 0) {
+                options.inputPath = argv[i + 1];
+            } else if (std::strcmp(argv[i], "--output") == 0) {
+                options.outputPath = argv[i + 1];
+            } else if (std::strcmp(argv[i], "--timeout-ms") == 0) {
+                options.lineTimeoutMs = std::atoi(argv[i + 1]);
+            } else if (std::strcmp(argv[i], "--node-budget") == 0) {
+                options.lineNodeBudget = std::atoll(argv[i + 1]);
+            } else if (std::strcmp(argv[i], "--trace") == 0) {
+                options.tracePath = argv[i + 1];
+            } else if (std::strcmp(argv[i], "--trace-sample") == 0) {
+                options.traceSampleEvery = std::atoi(argv[i + 1]);
+            }
+        }
+        processFileInput(options);
+        return 0;
+    }
+
+    if (argc > 1 && std::strcmp(argv[1], "--bench") == 0) {
+        runBenchmark();
+        return 0;
+    }
+
+    if (argc > 1 && std::strcmp(argv[1], "--bench-parallel") == 0) {
+        int threads = argc > 2 ? std::atoi(argv[2]) : (int)std::thread::hardware_concurrency();
+        runParallelBenchmark(threads);
+        return 0;
+    }
+
+    if (argc > 1 && std::strcmp(argv[1], "--simulate") == 0) {
+        long long rounds = argc > 2 ? std::atoll(argv[2]) : 1000000;
+        int threads = argc > 3 ? std::atoi(argv[3]) : (int)std::thread::hardware_concurrency();
+        printSimulationReport(runSimulation(rounds, threads), std::cout);
+        return 0;
+    }
+
+    if (argc > 3 && std::strcmp(argv[1], "--verify") == 0) {
+        int threads = argc > 4 ? std::atoi(argv[4]) : (int)std::thread::hardware_concurrency();
+        VerifyReport report;
+        if (!verifyFile(argv[2], argv[3], threads, report)) {
+            return 1;
+        }
+        std::cout << "correct " << report.correct << ", incorrect " << report.incorrect
+                  << ", malformed " << report.malformed << " in " << report.seconds << " s" << std::endl;
+        return 0;
+    }
 
-int main() {
     GameWindow* window = new GameWindow(800, 600, "24 Points Game");
     window->show();
     return Fl::run();
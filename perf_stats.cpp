@@ -0,0 +1,27 @@
+#include "perf_stats.h"
+#include <algorithm>
+
+RollingStat::RollingStat(size_t window)
+    : samples(window, 0), next(0), filled(0), lastSample(0) {
+}
+
+void RollingStat::add(double sample) {
+    samples[next] = sample;
+    next = (next + 1) % samples.size();
+    filled = std::min(filled + 1, samples.size());
+    lastSample = sample;
+}
+
+double RollingStat::mean() const {
+    if (filled == 0) return 0;
+    double sum = 0;
+    for (size_t i = 0; i < filled; i++) {
+        sum += samples[i];
+    }
+    return sum / filled;
+}
+
+double RollingStat::max() const {
+    if (filled == 0) return 0;
+    return *std::max_element(samples.begin(), samples.begin() + filled);
+}
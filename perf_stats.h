@@ -0,0 +1,34 @@
+#ifndef PERF_STATS_H
+#define PERF_STATS_H
+
+#include <cstddef>
+#include <vector>
+
+// Keeps the last `window` samples of one measurement for the overlay.
+class RollingStat {
+public:
+    explicit RollingStat(size_t window = 64);
+
+    void add(double sample);
+    size_t count() const { return filled; }
+    double last() const { return lastSample; }
+    double mean() const;
+    double max() const;
+
+private:
+    std::vector<double> samples;
+    size_t next;
+    size_t filled;
+    double lastSample;
+};
+
+struct PerfCounters {
+    RollingStat solveMs;
+    RollingStat solveNodes;
+    RollingStat rejectedHands;
+    RollingStat checkMs;
+    RollingStat tickJitterMs;
+    RollingStat redrawMs;
+};
+
+#endif
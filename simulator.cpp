@@ -0,0 +1,200 @@
+#include "simulator.h"
+#include "game_session.h"
+#include "solve24.h"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <random>
+#include <string>
+#include <thread>
+
+namespace {
+
+struct HandTable {
+    std::vector<std::vector<int>> hands;
+    std::vector<std::string> solutions;
+    // Sorted-hand code (base 14) to index into hands, or -1 if unsolvable.
+    std::vector<int> lookup;
+};
+
+int handCode(const std::vector<int>& sorted) {
+    int code = 0;
+    for (int card : sorted) {
+        code = code * 14 + card;
+    }
+    return code;
+}
+
+HandTable buildHandTable() {
+    HandTable table;
+    table.lookup.assign(14 * 14 * 14 * 14, -1);
+    for (int a = 1; a <= 13; a++)
+        for (int b = a; b <= 13; b++)
+            for (int c = b; c <= 13; c++)
+                for (int d = c; d <= 13; d++) {
+                    std::vector<int> hand = {a, b, c, d};
+                    std::vector<double> nums(hand.begin(), hand.end());
+                    std::vector<std::string> exprs;
+                    for (int num : hand) {
+                        exprs.push_back(std::to_string(num));
+                    }
+                    std::string solution;
+                    if (solve24(nums, exprs, solution)) {
+                        table.lookup[handCode(hand)] = (int)table.hands.size();
+                        table.hands.push_back(hand);
+                        table.solutions.push_back(solution);
+                    }
+                }
+    return table;
+}
+
+void mergeInto(SimulationReport& total, const SimulationReport& part) {
+    total.rounds += part.rounds;
+    total.games += part.games;
+    total.checks += part.checks;
+    total.correct += part.correct;
+    total.scoreSum += part.scoreSum;
+    total.maxScore = std::max(total.maxScore, part.maxScore);
+    total.latencyNsSum += part.latencyNsSum;
+    if (total.scoreHistogram.size() < part.scoreHistogram.size()) {
+        total.scoreHistogram.resize(part.scoreHistogram.size());
+    }
+    for (size_t i = 0; i < part.scoreHistogram.size(); i++) {
+        total.scoreHistogram[i] += part.scoreHistogram[i];
+    }
+    for (size_t i = 0; i < part.latencyHistogram.size(); i++) {
+        total.latencyHistogram[i] += part.latencyHistogram[i];
+    }
+}
+
+void recordGame(SimulationReport& report, int score) {
+    size_t bucket = score / SCORE_BUCKET;
+    if (report.scoreHistogram.size() <= bucket) {
+        report.scoreHistogram.resize(bucket + 1);
+    }
+    report.scoreHistogram[bucket]++;
+    report.scoreSum += score;
+    report.maxScore = std::max(report.maxScore, score);
+    report.games++;
+}
+
+void simulateWorker(const HandTable& table, long long rounds, unsigned seed, SimulationReport& report) {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> cardDist(1, 13);
+    std::uniform_real_distribution<double> thinkDist(2.0, 40.0);
+    std::bernoulli_distribution mistakeDist(0.3);
+
+    double now = 0;
+    int handIndex = 0;
+    GameSession session([&now]() { return now; }, [&]() {
+        std::vector<int> hand(4);
+        while (true) {
+            for (int& card : hand) {
+                card = cardDist(rng);
+            }
+            std::sort(hand.begin(), hand.end());
+            handIndex = table.lookup[handCode(hand)];
+            if (handIndex >= 0) {
+                return hand;
+            }
+        }
+    });
+
+    report.latencyHistogram.assign(32, 0);
+    while (report.rounds < rounds) {
+        session.startRound();
+        report.rounds++;
+
+        const std::vector<int>& cards = session.cards();
+        std::string wrongAnswer = std::to_string(cards[0]) + "+" + std::to_string(cards[1]) + "+" +
+                                  std::to_string(cards[2]) + "+" + std::to_string(cards[3]);
+        // Hands like 6 6 6 6 sum to 24; subtracting the last card then
+        // gives 24 - 2 * card, so the scripted mistake is always wrong.
+        if (GameSession::validateAnswer(cards, wrongAnswer)) {
+            wrongAnswer[wrongAnswer.rfind('+')] = '-';
+        }
+
+        while (true) {
+            now += thinkDist(rng);
+            if (session.update()) {
+                recordGame(report, session.score());
+                break;
+            }
+
+            const std::string& answer = mistakeDist(rng) ? wrongAnswer : table.solutions[handIndex];
+            auto begin = std::chrono::steady_clock::now();
+            CheckResult result = session.check(answer);
+            double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count();
+
+            report.checks++;
+            report.latencyNsSum += ns;
+            int bucket = 0;
+            while (bucket < 31 && ns >= (double)(2LL << bucket)) {
+                bucket++;
+            }
+            report.latencyHistogram[bucket]++;
+
+            if (result == CheckResult::Correct) {
+                report.correct++;
+                now += 1.0;
+                break;
+            }
+        }
+    }
+}
+
+}
+
+SimulationReport runSimulation(long long rounds, int threads) {
+    if (threads < 1) threads = 1;
+    HandTable table = buildHandTable();
+
+    std::vector<SimulationReport> parts(threads);
+    std::vector<std::thread> workers;
+    auto begin = std::chrono::steady_clock::now();
+    for (int t = 0; t < threads; t++) {
+        long long share = rounds / threads + (t < rounds % threads ? 1 : 0);
+        workers.emplace_back(simulateWorker, std::cref(table), share, 12345u + t, std::ref(parts[t]));
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+
+    SimulationReport total;
+    total.latencyHistogram.assign(32, 0);
+    for (const SimulationReport& part : parts) {
+        mergeInto(total, part);
+    }
+    total.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    return total;
+}
+
+void printSimulationReport(const SimulationReport& report, std::ostream& out) {
+    out << "rounds " << report.rounds << " in " << std::fixed << std::setprecision(2) << report.seconds << " s ("
+        << std::setprecision(0) << report.rounds / std::max(report.seconds, 1e-9) << " rounds/s)" << std::endl;
+    out << "checks " << report.checks << ", correct " << report.correct << std::endl;
+
+    out << "finished games " << report.games;
+    if (report.games > 0) {
+        out << ", mean score " << std::setprecision(1) << (double)report.scoreSum / report.games
+            << ", max " << report.maxScore;
+    }
+    out << std::endl;
+    for (size_t i = 0; i < report.scoreHistogram.size(); i++) {
+        if (report.scoreHistogram[i] == 0) continue;
+        out << "  score " << std::setw(6) << i * SCORE_BUCKET << "-" << std::setw(6) << (i + 1) * SCORE_BUCKET - 1
+            << ": " << report.scoreHistogram[i] << std::endl;
+    }
+
+    if (report.checks > 0) {
+        out << "check() mean " << std::setprecision(0) << report.latencyNsSum / report.checks << " ns" << std::endl;
+        long long seen = 0;
+        for (size_t b = 0; b < report.latencyHistogram.size(); b++) {
+            seen += report.latencyHistogram[b];
+            if (seen * 100 >= report.checks * 99) {
+                out << "check() p99 < " << (2LL << b) << " ns" << std::endl;
+                break;
+            }
+        }
+    }
+}
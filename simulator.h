@@ -0,0 +1,31 @@
+#ifndef SIMULATOR_H
+#define SIMULATOR_H
+
+#include <ostream>
+#include <vector>
+
+struct SimulationReport {
+    long long rounds = 0;
+    long long games = 0;
+    long long checks = 0;
+    long long correct = 0;
+    double seconds = 0;
+
+    // Final scores of finished games, in buckets of SCORE_BUCKET points.
+    std::vector<long long> scoreHistogram;
+    long long scoreSum = 0;
+    int maxScore = 0;
+
+    // check() latency, bucket b counts calls taking [2^b, 2^(b+1)) ns.
+    std::vector<long long> latencyHistogram;
+    double latencyNsSum = 0;
+};
+
+const int SCORE_BUCKET = 500;
+
+// Plays `rounds` rounds of scripted players against headless GameSessions on
+// `threads` threads, with a virtual clock so no round waits in real time.
+SimulationReport runSimulation(long long rounds, int threads);
+void printSimulationReport(const SimulationReport& report, std::ostream& out);
+
+#endif
@@ -6,6 +6,18 @@
 #include <sstream>
 #include <fstream>
 #include <algorithm>
+#include <set>
+#include <chrono>
+#include <cstdint>
+#include <array>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <random>
+#include <thread>
+#include "solve24.h"
+#include "batch_io.h"
+#include "trace.h"
 
 using namespace std;
 
@@ -42,10 +54,160 @@ double calculate(double a, double b, char op, const string& expr1, const string&
 }
 
 
-bool solve24Helper(vector<double>& nums, vector<string>& exprs, string& solution);
+// Direct-mapped table of value multisets already proven unable to reach 24
+// in the current search. Bumping the generation empties it between hands.
+class DeadStateTable {
+public:
+    static const size_t SIZE = 2048;
+    static const size_t MAX_VALUES = 6;
+
+    struct Key {
+        uint64_t hash;
+        size_t count;
+        int64_t values[MAX_VALUES];
+    };
+
+    void reset() {
+        if (++generation == 0) {
+            fill(entries.begin(), entries.end(), Entry());
+            generation = 1;
+        }
+    }
+
+    // Values are compared after rounding to 1e-9, well inside EPSILON.
+    bool makeKey(const vector<double>& nums, Key& key) const {
+        if (nums.size() > MAX_VALUES) return false;
+        key.count = nums.size();
+        for (size_t i = 0; i < nums.size(); ++i) {
+            if (fabs(nums[i]) > 1e9) return false;
+            int64_t value = llround(nums[i] * 1e9);
+            size_t k = i;
+            for (; k > 0 && key.values[k - 1] > value; --k) {
+                key.values[k] = key.values[k - 1];
+            }
+            key.values[k] = value;
+        }
+        key.hash = 1469598103934665603ULL;
+        for (size_t i = 0; i < key.count; ++i) {
+            key.hash = (key.hash ^ (uint64_t)key.values[i]) * 1099511628211ULL;
+        }
+        return true;
+    }
+
+    bool contains(const Key& key) const {
+        const Entry& entry = entries[key.hash & (SIZE - 1)];
+        return entry.generation == generation && entry.hash == key.hash && entry.count == key.count &&
+               equal(key.values, key.values + key.count, entry.values);
+    }
+
+    void insert(const Key& key) {
+        Entry& entry = entries[key.hash & (SIZE - 1)];
+        entry.hash = key.hash;
+        entry.generation = generation;
+        entry.count = key.count;
+        copy(key.values, key.values + key.count, entry.values);
+    }
+
+private:
+    struct Entry {
+        uint64_t hash = 0;
+        uint32_t generation = 0;
+        size_t count = 0;
+        int64_t values[MAX_VALUES] = {};
+    };
+
+    vector<Entry> entries = vector<Entry>(SIZE);
+    uint32_t generation = 0;
+};
+
+
+struct SearchContext {
+    const SolveOptions& options;
+    const SolveLimits& limits;
+    SolveStats& stats;
+    long long startNodes;
+    bool gaveUp;
+    DeadStateTable* deadStates;
+};
+
+
+// Called once per node. The budget is a plain compare; the clock and the
+// cancellation flag are only looked at every 256 nodes.
+bool outOfBudget(SearchContext& ctx) {
+    if (ctx.gaveUp) {
+        return true;
+    }
+    long long explored = ctx.stats.nodes - ctx.startNodes;
+    if (ctx.limits.nodeBudget > 0 && explored > ctx.limits.nodeBudget) {
+        ctx.gaveUp = true;
+    } else if ((explored & 255) == 0) {
+        if (ctx.limits.cancel && ctx.limits.cancel->load(memory_order_relaxed)) {
+            ctx.gaveUp = true;
+        } else if (ctx.limits.deadline != chrono::steady_clock::time_point::max() &&
+                   chrono::steady_clock::now() >= ctx.limits.deadline) {
+            ctx.gaveUp = true;
+        }
+    }
+    return ctx.gaveUp;
+}
+
+
+struct Move {
+    size_t left;
+    size_t right;
+    char op;
+    double value;
+};
+
+
+bool solve24Helper(vector<double>& nums, vector<string>& exprs, string& solution, SearchContext& ctx);
+template <size_t N>
+bool solveFixedHand(const vector<double>& nums, const vector<string>& exprs, string& solution, SearchContext& ctx);
+bool solve24PrunedHelper(vector<double>& nums, vector<string>& exprs, string& solution, SearchContext& ctx);
+vector<Move> generateMoves(const vector<double>& nums, bool orderMoves);
+void applyMove(const vector<double>& nums, const vector<string>& exprs, const Move& move,
+               vector<double>& rest_nums, vector<string>& rest_exprs);
 
 
 bool solve24(vector<double>& nums, vector<string>& exprs, string& solution) {
+    return solve24(nums, exprs, solution, SolveOptions());
+}
+
+
+bool solve24(vector<double>& nums, vector<string>& exprs, string& solution, const SolveOptions& options, SolveStats* stats) {
+    return solve24(nums, exprs, solution, options, SolveLimits(), stats) == SolveResult::Solved;
+}
+
+
+SolveResult solve24(vector<double>& nums, vector<string>& exprs, string& solution,
+                    const SolveOptions& options, const SolveLimits& limits, SolveStats* stats) {
+    SolveStats localStats;
+    SolveStats& counters = stats ? *stats : localStats;
+    SearchContext ctx{options, limits, counters, counters.nodes, false, nullptr};
+
+    if (options.transpositionTable) {
+        static thread_local DeadStateTable deadStates;
+        deadStates.reset();
+        ctx.deadStates = &deadStates;
+    }
+
+    if (options.fixedArity && nums.size() == 4) {
+        if (solveFixedHand<4>(nums, exprs, solution, ctx)) {
+            return SolveResult::Solved;
+        }
+        return ctx.gaveUp ? SolveResult::GaveUp : SolveResult::Unsolvable;
+    }
+
+    if (options.prune) {
+        // The pruned helper tries both operand orders itself, so permuting
+        // the input would only revisit the same expression trees.
+        vector<double> work_nums = nums;
+        vector<string> work_exprs = exprs;
+        if (solve24PrunedHelper(work_nums, work_exprs, solution, ctx)) {
+            return SolveResult::Solved;
+        }
+        return ctx.gaveUp ? SolveResult::GaveUp : SolveResult::Unsolvable;
+    }
     
     vector<int> indices(nums.size());
     for (size_t i = 0; i < indices.size(); i++) {
@@ -62,16 +224,20 @@ bool solve24(vector<double>& nums, vector<string>& exprs, string& solution) {
         }
 
         
-        if (solve24Helper(permuted_nums, permuted_exprs, solution)) {
-            return true;
+        if (solve24Helper(permuted_nums, permuted_exprs, solution, ctx)) {
+            return SolveResult::Solved;
         }
-    } while (next_permutation(indices.begin(), indices.end()));
+    } while (!ctx.gaveUp && next_permutation(indices.begin(), indices.end()));
 
-    return false;
+    return ctx.gaveUp ? SolveResult::GaveUp : SolveResult::Unsolvable;
 }
 
 
-bool solve24Helper(vector<double>& nums, vector<string>& exprs, string& solution) {
+bool solve24Helper(vector<double>& nums, vector<string>& exprs, string& solution, SearchContext& ctx) {
+    ctx.stats.nodes++;
+    if (outOfBudget(ctx)) {
+        return false;
+    }
     if (nums.size() == 1) {
         if (isCloseTo24(nums[0])) {
             solution = exprs[0];
@@ -103,9 +269,12 @@ bool solve24Helper(vector<double>& nums, vector<string>& exprs, string& solution
                 rest_nums.push_back(result);
                 rest_exprs.push_back(new_expr);
 
-                if (solve24Helper(rest_nums, rest_exprs, solution)) {
+                if (solve24Helper(rest_nums, rest_exprs, solution, ctx)) {
                     return true;
                 }
+                if (ctx.gaveUp) {
+                    return false;
+                }
 
                 rest_nums.pop_back();
                 rest_exprs.pop_back();
@@ -115,18 +284,620 @@ bool solve24Helper(vector<double>& nums, vector<string>& exprs, string& solution
     return false;
 }
 
+
+// With integer operands every intermediate value is N/D for integers
+// |N|, |D| <= 2^(n-1) * prod(max(|x|, 1)), and D != 0, so that bound also
+// caps |value|. Non-integer states are never pruned.
+bool cannotReach24(const vector<double>& nums) {
+    double bound = 1;
+    for (size_t i = 0; i < nums.size(); ++i) {
+        if (fabs(nums[i] - round(nums[i])) >= EPSILON) {
+            return false;
+        }
+        bound *= max(fabs(nums[i]), 1.0) * (i == 0 ? 1 : 2);
+    }
+    return bound < 24 - EPSILON;
+}
+
+
+void addMove(vector<Move>& moves, size_t pairStart, size_t left, size_t right, char op, double value) {
+    for (size_t k = pairStart; k < moves.size(); ++k) {
+        if (moves[k].value == value) {
+            return;
+        }
+    }
+    moves.push_back({left, right, op, value});
+}
+
+
+bool solve24PrunedHelper(vector<double>& nums, vector<string>& exprs, string& solution, SearchContext& ctx) {
+    ctx.stats.nodes++;
+    if (outOfBudget(ctx)) {
+        return false;
+    }
+    if (nums.size() == 1) {
+        if (isCloseTo24(nums[0])) {
+            solution = exprs[0];
+            return true;
+        }
+        return false;
+    }
+
+    if (cannotReach24(nums)) {
+        return false;
+    }
+
+    DeadStateTable::Key key;
+    bool cacheable = ctx.deadStates && ctx.deadStates->makeKey(nums, key);
+    if (cacheable && ctx.deadStates->contains(key)) {
+        ctx.stats.deadStateHits++;
+        return false;
+    }
+
+    vector<Move> moves = generateMoves(nums, ctx.options.orderMoves);
+
+    vector<double> rest_nums;
+    vector<string> rest_exprs;
+    for (const Move& move : moves) {
+        rest_nums.clear();
+        rest_exprs.clear();
+        applyMove(nums, exprs, move, rest_nums, rest_exprs);
+
+        if (solve24PrunedHelper(rest_nums, rest_exprs, solution, ctx)) {
+            return true;
+        }
+        if (ctx.gaveUp) {
+            return false;
+        }
+    }
+
+    if (cacheable && !ctx.gaveUp) {
+        ctx.deadStates->insert(key);
+    }
+    return false;
+}
+
+
+vector<Move> generateMoves(const vector<double>& nums, bool orderMoves) {
+    vector<Move> moves;
+    vector<pair<double, double>> triedPairs;
+    for (size_t i = 0; i < nums.size(); ++i) {
+        for (size_t j = i + 1; j < nums.size(); ++j) {
+            double a = nums[i];
+            double b = nums[j];
+
+            // Equal values leave an identical remaining multiset.
+            pair<double, double> key(min(a, b), max(a, b));
+            if (find(triedPairs.begin(), triedPairs.end(), key) != triedPairs.end()) continue;
+            triedPairs.push_back(key);
+
+            size_t pairStart = moves.size();
+            addMove(moves, pairStart, i, j, '+', a + b);
+            addMove(moves, pairStart, i, j, '*', a * b);
+            addMove(moves, pairStart, i, j, '-', a - b);
+            addMove(moves, pairStart, j, i, '-', b - a);
+            if (b != 0) addMove(moves, pairStart, i, j, '/', a / b);
+            if (a != 0) addMove(moves, pairStart, j, i, '/', b / a);
+        }
+    }
+
+    if (orderMoves) {
+        stable_sort(moves.begin(), moves.end(), [](const Move& x, const Move& y) {
+            return fabs(x.value - 24) < fabs(y.value - 24);
+        });
+    }
+    return moves;
+}
+
+
+void applyMove(const vector<double>& nums, const vector<string>& exprs, const Move& move,
+               vector<double>& rest_nums, vector<string>& rest_exprs) {
+    for (size_t k = 0; k < nums.size(); ++k) {
+        if (k != move.left && k != move.right) {
+            rest_nums.push_back(nums[k]);
+            rest_exprs.push_back(exprs[k]);
+        }
+    }
+    rest_nums.push_back(move.value);
+    rest_exprs.push_back("(" + exprs[move.left] + " " + move.op + " " + exprs[move.right] + ")");
+}
+
+
+// Expression tree for solve<N>(). Leaves are the input cards and every level
+// writes its combined node into its own slot, so the nodes on the current
+// path stay valid and a string is only built for the final answer.
+struct FixedExprPool {
+    static const size_t MAX_NODES = 16;
+    const vector<string>* leaves;
+    size_t leafCount;
+    size_t left[MAX_NODES];
+    size_t right[MAX_NODES];
+    char op[MAX_NODES];
+
+    string render(size_t node) const {
+        if (node < leafCount) {
+            return (*leaves)[node];
+        }
+        return "(" + render(left[node]) + " " + op[node] + " " + render(right[node]) + ")";
+    }
+};
+
+
+struct FixedValue {
+    double value;
+    size_t node;
+};
+
+
+// One instantiation per remaining hand size, so the pair loops have constant
+// trip counts and the values live in fixed-size arrays. Pairs of equal values
+// and equal results within a pair are skipped as in generateMoves().
+template <size_t N>
+bool solve(const array<FixedValue, N>& values, FixedExprPool& pool, size_t& answer, SearchContext& ctx) {
+    ctx.stats.nodes++;
+    if (outOfBudget(ctx)) {
+        return false;
+    }
+
+    const size_t slot = 2 * pool.leafCount - N;
+    array<pair<double, double>, N * (N - 1) / 2> triedPairs;
+    size_t triedCount = 0;
+    array<FixedValue, N - 1> rest;
+
+    for (size_t i = 0; i < N; ++i) {
+        for (size_t j = i + 1; j < N; ++j) {
+            double a = values[i].value;
+            double b = values[j].value;
+            pair<double, double> key(min(a, b), max(a, b));
+            if (find(triedPairs.begin(), triedPairs.begin() + triedCount, key) != triedPairs.begin() + triedCount) continue;
+            triedPairs[triedCount++] = key;
+
+            size_t k = 0;
+            for (size_t m = 0; m < N; ++m) {
+                if (m != i && m != j) rest[k++] = values[m];
+            }
+
+            Move moves[6];
+            size_t count = 0;
+            auto addResult = [&](size_t left, size_t right, char op, double value) {
+                for (size_t c = 0; c < count; ++c) {
+                    if (moves[c].value == value) return;
+                }
+                moves[count++] = {left, right, op, value};
+            };
+            addResult(i, j, '+', a + b);
+            addResult(i, j, '*', a * b);
+            addResult(i, j, '-', a - b);
+            addResult(j, i, '-', b - a);
+            if (b != 0) addResult(i, j, '/', a / b);
+            if (a != 0) addResult(j, i, '/', b / a);
+
+            for (size_t c = 0; c < count; ++c) {
+                pool.left[slot] = values[moves[c].left].node;
+                pool.right[slot] = values[moves[c].right].node;
+                pool.op[slot] = moves[c].op;
+                rest[N - 2] = {moves[c].value, slot};
+                if (solve<N - 1>(rest, pool, answer, ctx)) {
+                    return true;
+                }
+                if (ctx.gaveUp) {
+                    return false;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+
+template <>
+bool solve<1>(const array<FixedValue, 1>& values, FixedExprPool&, size_t& answer, SearchContext& ctx) {
+    ctx.stats.nodes++;
+    if (outOfBudget(ctx)) {
+        return false;
+    }
+    if (isCloseTo24(values[0].value)) {
+        answer = values[0].node;
+        return true;
+    }
+    return false;
+}
+
+
+template <size_t N>
+bool solveFixedHand(const vector<double>& nums, const vector<string>& exprs, string& solution, SearchContext& ctx) {
+    static_assert(2 * N - 1 <= FixedExprPool::MAX_NODES, "hand too large for FixedExprPool");
+    FixedExprPool pool;
+    pool.leaves = &exprs;
+    pool.leafCount = N;
+    array<FixedValue, N> values;
+    for (size_t i = 0; i < N; ++i) {
+        values[i] = {nums[i], i};
+    }
+
+    size_t answer;
+    if (!solve<N>(values, pool, answer, ctx)) {
+        return false;
+    }
+    solution = pool.render(answer);
+    return true;
+}
+
+
+struct SearchTask {
+    vector<double> nums;
+    vector<string> exprs;
+};
+
+
+// Per-worker deque: the owner pushes and pops at the back (depth first),
+// thieves take from the front, where the biggest remaining subtrees are.
+struct WorkerQueue {
+    mutex lock;
+    deque<SearchTask> tasks;
+};
+
+
+struct ParallelSearch {
+    const SolveOptions& options;
+    const SolveLimits& limits;
+    size_t splitAbove;
+    vector<WorkerQueue> queues;
+    // Tasks queued or running; the search is over when this reaches 0.
+    atomic<long long> pending{0};
+    // Tasks sitting in a deque; idle workers sleep on `idle` until one shows up.
+    atomic<long long> queued{0};
+    mutex idleLock;
+    condition_variable idle;
+    atomic<long long> nodes{0};
+    atomic<long long> deadStateHits{0};
+    atomic<bool> stop{false};
+    atomic<bool> gaveUp{false};
+    mutex solutionLock;
+    bool found = false;
+    string solution;
+
+    ParallelSearch(const SolveOptions& options, const SolveLimits& limits, size_t splitAbove, int threads)
+        : options(options), limits(limits), splitAbove(splitAbove), queues(threads) {}
+
+    void push(int worker, SearchTask&& task) {
+        pending++;
+        {
+            lock_guard<mutex> guard(queues[worker].lock);
+            queues[worker].tasks.push_back(move(task));
+        }
+        queued++;
+        wake(false);
+    }
+
+    void finishTask() {
+        if (--pending == 0) {
+            wake(true);
+        }
+    }
+
+    void halt(bool limitReached) {
+        if (limitReached) {
+            gaveUp = true;
+        }
+        stop = true;
+        wake(true);
+    }
+
+    // Taking idleLock before notifying means a worker that has just checked
+    // the wait condition cannot miss the wakeup.
+    void wake(bool all) {
+        lock_guard<mutex> guard(idleLock);
+        if (all) {
+            idle.notify_all();
+        } else {
+            idle.notify_one();
+        }
+    }
+
+    bool pop(int worker, SearchTask& task) {
+        {
+            lock_guard<mutex> guard(queues[worker].lock);
+            if (!queues[worker].tasks.empty()) {
+                task = move(queues[worker].tasks.back());
+                queues[worker].tasks.pop_back();
+                queued--;
+                return true;
+            }
+        }
+        for (size_t k = 1; k < queues.size(); ++k) {
+            WorkerQueue& victim = queues[(worker + k) % queues.size()];
+            lock_guard<mutex> guard(victim.lock);
+            if (!victim.tasks.empty()) {
+                task = move(victim.tasks.front());
+                victim.tasks.pop_front();
+                queued--;
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+
+// Expands a task into its child tasks, or searches it serially once it is
+// small enough. A solution or an exhausted limit stops every worker.
+void runSearchTask(ParallelSearch& search, int worker, SearchTask& task, DeadStateTable* deadStates) {
+    SolveStats stats;
+    SolveLimits taskLimits;
+    taskLimits.deadline = search.limits.deadline;
+    taskLimits.cancel = &search.stop;
+    if (search.limits.nodeBudget > 0) {
+        taskLimits.nodeBudget = max(search.limits.nodeBudget - search.nodes.load(), 1LL);
+    }
+    SearchContext ctx{search.options, taskLimits, stats, 0, false, deadStates};
+
+    string solution;
+    bool solved = false;
+    if (task.nums.size() > search.splitAbove) {
+        stats.nodes++;
+        if (!cannotReach24(task.nums)) {
+            vector<Move> moves = generateMoves(task.nums, search.options.orderMoves);
+            // Pushed in reverse so the owner pops them in move order.
+            for (size_t k = moves.size(); k-- > 0;) {
+                SearchTask child;
+                applyMove(task.nums, task.exprs, moves[k], child.nums, child.exprs);
+                search.push(worker, move(child));
+            }
+        }
+    } else if (search.options.fixedArity && task.nums.size() == 4) {
+        solved = solveFixedHand<4>(task.nums, task.exprs, solution, ctx);
+    } else {
+        solved = solve24PrunedHelper(task.nums, task.exprs, solution, ctx);
+    }
+
+    search.nodes += stats.nodes;
+    search.deadStateHits += stats.deadStateHits;
+    if (solved) {
+        {
+            lock_guard<mutex> guard(search.solutionLock);
+            if (!search.found) {
+                search.found = true;
+                search.solution = solution;
+            }
+        }
+        search.halt(false);
+    } else if (ctx.gaveUp && !search.stop) {
+        search.halt(true);
+    }
+}
+
+
+void parallelWorker(ParallelSearch& search, int worker) {
+    DeadStateTable deadStates;
+    deadStates.reset();
+    DeadStateTable* table = search.options.transpositionTable ? &deadStates : nullptr;
+    SearchTask task;
+    while (!search.stop && search.pending > 0) {
+        if ((search.limits.cancel && search.limits.cancel->load(memory_order_relaxed)) ||
+            (search.limits.nodeBudget > 0 && search.nodes >= search.limits.nodeBudget)) {
+            search.halt(true);
+            break;
+        }
+        if (!search.pop(worker, task)) {
+            unique_lock<mutex> guard(search.idleLock);
+            search.idle.wait(guard, [&search] {
+                return search.stop || search.pending == 0 || search.queued > 0;
+            });
+            continue;
+        }
+        runSearchTask(search, worker, task, table);
+        search.finishTask();
+    }
+}
+
+
+SolveResult solve24Parallel(vector<double>& nums, vector<string>& exprs, string& solution, int threads,
+                            const SolveOptions& options, const SolveLimits& limits, SolveStats* stats) {
+    // Only the pruned search is split into tasks; the exhaustive one keeps
+    // its serial permutation loop.
+    // More workers than hardware threads only add context switches.
+    int hardwareThreads = (int)thread::hardware_concurrency();
+    if (hardwareThreads > 0) {
+        threads = min(threads, hardwareThreads);
+    }
+    if (threads <= 1 || nums.size() <= 5 || !options.prune) {
+        return solve24(nums, exprs, solution, options, limits, stats);
+    }
+
+    ParallelSearch search(options, limits, nums.size() - 2, threads);
+    search.push(0, SearchTask{nums, exprs});
+
+    vector<thread> workers;
+    for (int t = 1; t < threads; t++) {
+        workers.emplace_back(parallelWorker, ref(search), t);
+    }
+    parallelWorker(search, 0);
+    for (thread& worker : workers) {
+        worker.join();
+    }
+
+    if (stats) {
+        stats->nodes += search.nodes;
+        stats->deadStateHits += search.deadStateHits;
+    }
+    if (search.found) {
+        solution = search.solution;
+        return SolveResult::Solved;
+    }
+    return search.gaveUp ? SolveResult::GaveUp : SolveResult::Unsolvable;
+}
+
+
+struct SolutionGenerator::Frame {
+    vector<double> nums;
+    vector<string> exprs;
+    vector<Move> moves;
+    size_t nextMove;
+};
+
+
+SolutionGenerator::SolutionGenerator(const vector<double>& nums, const vector<string>& exprs)
+    : exploredNodes(0), pendingRoot(false) {
+    if (nums.size() == 1) {
+        pendingRoot = isCloseTo24(nums[0]);
+        rootExpr = exprs[0];
+        return;
+    }
+    if (!nums.empty() && !cannotReach24(nums)) {
+        stack.push_back({nums, exprs, generateMoves(nums, true), 0});
+    }
+}
+
+
+SolutionGenerator::~SolutionGenerator() {
+}
+
+
+// Out of line, like the destructor, because Frame is incomplete in the header.
+bool SolutionGenerator::done() const {
+    return stack.empty() && !pendingRoot;
+}
+
+
+SolutionGenerator::Status SolutionGenerator::next(string& solution, long long maxNodes) {
+    if (pendingRoot) {
+        pendingRoot = false;
+        solution = rootExpr;
+        return Status::Found;
+    }
+
+    long long budget = maxNodes;
+    while (!stack.empty()) {
+        if (budget <= 0) {
+            return Status::Paused;
+        }
+
+        Frame& top = stack.back();
+        if (top.nextMove >= top.moves.size()) {
+            stack.pop_back();
+            continue;
+        }
+
+        Frame child;
+        child.nextMove = 0;
+        applyMove(top.nums, top.exprs, top.moves[top.nextMove++], child.nums, child.exprs);
+        exploredNodes++;
+        budget--;
+
+        if (child.nums.size() == 1) {
+            if (isCloseTo24(child.nums[0])) {
+                solution = child.exprs[0];
+                return Status::Found;
+            }
+            continue;
+        }
+        if (cannotReach24(child.nums)) {
+            continue;
+        }
+
+        child.moves = generateMoves(child.nums, true);
+        stack.push_back(move(child));
+    }
+    return Status::Exhausted;
+}
+
+
+void addReachableValue(vector<Expression>& values, set<double>& seen, double value, const string& expr) {
+    auto it = seen.lower_bound(value - EPSILON);
+    if (it != seen.end() && *it < value + EPSILON) {
+        return;
+    }
+    seen.insert(value);
+    values.push_back(Expression(expr, value));
+}
+
+
+ReachableTargets reachableTargets(const vector<double>& nums, const vector<string>& exprs, int maxTarget,
+                                  bool withWitnesses) {
+    ReachableTargets targets;
+    size_t n = nums.size();
+    if (n == 0 || maxTarget < 1) {
+        return targets;
+    }
+
+    // values[mask] holds every distinct value (with one expression) that the
+    // cards in mask can make, so each subset is combined exactly once.
+    // Without witnesses the expressions stay empty and no strings are built.
+    size_t full = (size_t(1) << n) - 1;
+    vector<vector<Expression>> values(full + 1);
+    for (size_t i = 0; i < n; i++) {
+        values[size_t(1) << i].push_back(Expression(withWitnesses ? exprs[i] : "", nums[i]));
+    }
+    auto join = [withWitnesses](const string& x, char op, const string& y) {
+        return withWitnesses ? "(" + x + " " + op + " " + y + ")" : string();
+    };
+
+    for (size_t mask = 1; mask <= full; mask++) {
+        if ((mask & (mask - 1)) == 0) continue;
+
+        set<double> seen;
+        for (size_t left = (mask - 1) & mask; left > 0; left = (left - 1) & mask) {
+            size_t right = mask ^ left;
+            if (left < right) continue;
+
+            for (const Expression& a : values[left]) {
+                for (const Expression& b : values[right]) {
+                    vector<Expression>& out = values[mask];
+                    addReachableValue(out, seen, a.value + b.value, join(a.expr, '+', b.expr));
+                    addReachableValue(out, seen, a.value - b.value, join(a.expr, '-', b.expr));
+                    addReachableValue(out, seen, b.value - a.value, join(b.expr, '-', a.expr));
+                    addReachableValue(out, seen, a.value * b.value, join(a.expr, '*', b.expr));
+                    if (b.value != 0) {
+                        addReachableValue(out, seen, a.value / b.value, join(a.expr, '/', b.expr));
+                    }
+                    if (a.value != 0) {
+                        addReachableValue(out, seen, b.value / a.value, join(b.expr, '/', a.expr));
+                    }
+                }
+            }
+        }
+    }
+
+    // Size the result by the largest value the hand actually makes, so a
+    // huge maxTarget costs nothing extra.
+    double largest = 0;
+    for (const Expression& e : values[full]) {
+        largest = max(largest, e.value);
+    }
+    int limit = (int)min((double)maxTarget, floor(largest + EPSILON));
+    if (limit < 1) {
+        return targets;
+    }
+    targets.reachable.assign(limit + 1, false);
+    if (withWitnesses) {
+        targets.witnesses.assign(limit + 1, "");
+    }
+
+    for (const Expression& e : values[full]) {
+        double rounded = round(e.value);
+        if (fabs(e.value - rounded) >= EPSILON || rounded < 1 || rounded > limit) continue;
+
+        int target = (int)rounded;
+        if (!targets.reachable[target]) {
+            targets.reachable[target] = true;
+            if (withWitnesses) {
+                targets.witnesses[target] = e.expr;
+            }
+        }
+    }
+    return targets;
+}
+
 bool isValidInput(const string& input) {
     vector<string> validInputs = {"A", "1", "2", "3", "4", "5", "6", "7", "8", "9", "10", "J", "Q", "K"};
     return find(validInputs.begin(), validInputs.end(), input) != validInputs.end();
 }
 
 
-bool processLine(const string& line, string& result, string& solution) {
-    vector<double> nums(4);
-    vector<string> exprs(4);
+bool parseHand(const string& line, vector<double>& nums, vector<string>& exprs, string& result) {
     stringstream ss(line);
     string input;
-    int i = 0;
     
     
     vector<string> inputs;
@@ -139,7 +910,9 @@ bool processLine(const string& line, string& result, string& solution) {
         return false;
     }
     
-    
+    nums.assign(4, 0);
+    exprs.assign(4, "");
+    int i = 0;
     for (const string& input : inputs) {
         if (!isValidInput(input)) {
             result = "! Invalid input: " + input + " is not a valid card value";
@@ -161,13 +934,55 @@ bool processLine(const string& line, string& result, string& solution) {
         exprs[i] = input;
         i++;
     }
+    return true;
+}
+
+
+bool processLine(const string& line, string& result, string& solution, const SolveLimits& limits) {
+    TRACE_SCOPE("processLine");
+    vector<double> nums;
+    vector<string> exprs;
+    {
+        TRACE_SCOPE("parse");
+        if (!parseHand(line, nums, exprs, result)) {
+            return false;
+        }
+    }
 
-    bool success = solve24(nums, exprs, solution);
+    SolveResult outcome;
+    {
+        TRACE_SCOPE("solve");
+        outcome = solve24(nums, exprs, solution, SolveOptions(), limits);
+    }
+    if (outcome == SolveResult::GaveUp) {
+        result = "? " + line;
+        return false;
+    }
+    bool success = outcome == SolveResult::Solved;
     result = (success ? "+ " : "- ") + line;
     return success;
 }
 
 
+void appendTargets(const string& line, int targetLimit, string& result) {
+    vector<double> nums;
+    vector<string> exprs;
+    string error;
+    if (!parseHand(line, nums, exprs, error)) {
+        return;
+    }
+
+    TRACE_SCOPE("targets");
+    ReachableTargets targets = reachableTargets(nums, exprs, targetLimit, false);
+    result += " :";
+    for (size_t target = 1; target < targets.reachable.size(); target++) {
+        if (targets.reachable[target]) {
+            result += " " + to_string(target);
+        }
+    }
+}
+
+
 void processConsoleInput() {
     while (true) {
         cout << "Please enter 4 numbers (A, 2-10, J, Q, K), separated by spaces:" << endl;
@@ -196,37 +1011,237 @@ void processConsoleInput() {
 }
 
 
-void processFileInput() {
-    ifstream inFile("test.txt");
-    ofstream outFile("test_result.txt");
+static void processFile(const BatchOptions& options) {
+    TRACE_SCOPE("processFileInput");
+    LineSource inFile(options.inputPath);
     
-    if (!inFile.is_open()) {
+    if (!inFile.isOpen()) {
         cout << "Cannot open input file!" << endl;
         return;
     }
 
-    string line;
+    LineSink outFile(options.outputPath, compressionForPath(options.outputPath));
+    if (!outFile.isOpen()) {
+        cout << "Cannot open output file!" << endl;
+        return;
+    }
+
+    vector<string> lines;
     int totalCount = 0;
     int successCount = 0;
+    int timedOutCount = 0;
     
-    while (getline(inFile, line)) {
-        if (line.empty()) continue;
-        
-        string result, solution;
-        bool success = processLine(line, result, solution);
-        
-        if (success) successCount++;
-        totalCount++;
-        
-        outFile << result << endl;
+    while (inFile.next(lines)) {
+        for (const string& line : lines) {
+            if (line.empty()) continue;
+            TRACE_SAMPLE(totalCount);
+            
+            SolveLimits limits;
+            limits.nodeBudget = options.lineNodeBudget;
+            if (options.lineTimeoutMs > 0) {
+                limits.deadline = chrono::steady_clock::now() + chrono::milliseconds(options.lineTimeoutMs);
+            }
+            
+            string result, solution;
+            bool success = processLine(line, result, solution, limits);
+            if (result[0] == '?') {
+                timedOutCount++;
+            } else if (options.targetLimit > 0 && result[0] != '!') {
+                appendTargets(line, options.targetLimit, result);
+            }
+            
+            if (success) successCount++;
+            totalCount++;
+            
+            TRACE_SCOPE("write");
+            outFile.writeLine(result);
+        }
     }
     
-    outFile << successCount << "/" << totalCount << endl;
+    // A run cut short by bad input must not look complete, so the error
+    // replaces the summary line.
+    string error = inFile.error();
+    if (error.empty()) {
+        outFile.writeLine(to_string(successCount) + "/" + to_string(totalCount));
+    } else {
+        outFile.writeLine("! " + error);
+    }
     
-    inFile.close();
-    outFile.close();
+    if (!outFile.close()) {
+        error = "Cannot write output file!";
+    }
+    if (!error.empty()) {
+        cout << error << endl;
+        return;
+    }
+    if (timedOutCount > 0) {
+        cout << timedOutCount << " line(s) gave up before finishing, marked with '?'" << endl;
+    }
     
-    cout << "Processing complete! Results saved to test_result.txt" << endl;
+    cout << "Processing complete! Results saved to " << options.outputPath << endl;
+}
+
+
+void processFileInput(const BatchOptions& options) {
+    if (!options.tracePath.empty() && traceStart(options.tracePath, options.traceSampleEvery)) {
+        TRACE_THREAD_NAME("batch");
+    }
+    processFile(options);
+    if (traceStop()) {
+        cout << "Trace saved to " << options.tracePath << endl;
+    }
+}
+
+
+vector<vector<double>> allHands() {
+    vector<vector<double>> hands;
+    for (int a = 1; a <= 13; a++)
+        for (int b = a; b <= 13; b++)
+            for (int c = b; c <= 13; c++)
+                for (int d = c; d <= 13; d++)
+                    hands.push_back({double(a), double(b), double(c), double(d)});
+    return hands;
+}
+
+
+void benchmarkMode(const string& name, const vector<vector<double>>& hands, const SolveOptions& options) {
+    // Node counts are deterministic; times are the best of a few passes.
+    const int passes = 5;
+    long long solvedNodes = 0;
+    long long unsolvedNodes = 0;
+    int solvedCount = 0;
+    double solvedMs = 1e300;
+    double unsolvedMs = 1e300;
+
+    for (int pass = 0; pass < passes; pass++) {
+        solvedNodes = unsolvedNodes = 0;
+        solvedCount = 0;
+        double passSolvedMs = 0;
+        double passUnsolvedMs = 0;
+
+        for (const vector<double>& hand : hands) {
+            vector<double> nums = hand;
+            vector<string> exprs;
+            for (double num : hand) {
+                exprs.push_back(to_string((int)num));
+            }
+
+            string solution;
+            SolveStats stats;
+            auto begin = chrono::steady_clock::now();
+            bool solved = solve24(nums, exprs, solution, options, &stats);
+            double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - begin).count();
+
+            if (solved) {
+                solvedCount++;
+                solvedNodes += stats.nodes;
+                passSolvedMs += ms;
+            } else {
+                unsolvedNodes += stats.nodes;
+                passUnsolvedMs += ms;
+            }
+        }
+        solvedMs = min(solvedMs, passSolvedMs);
+        unsolvedMs = min(unsolvedMs, passUnsolvedMs);
+    }
+
+    cout << left << setw(18) << name
+         << " solved " << solvedCount << "/" << hands.size()
+         << "  nodes " << setw(9) << solvedNodes + unsolvedNodes
+         << " (solvable " << setw(8) << solvedNodes << " unsolvable " << setw(9) << unsolvedNodes << ")"
+         << "  ms " << fixed << setprecision(1) << solvedMs + unsolvedMs
+         << " (solvable " << solvedMs << " unsolvable " << unsolvedMs << ")" << endl;
+}
+
+
+void runBenchmark() {
+    vector<vector<double>> hands = allHands();
+
+    SolveOptions exhaustive;
+    exhaustive.prune = false;
+    exhaustive.fixedArity = false;
+    SolveOptions pruned;
+    pruned.orderMoves = false;
+    pruned.transpositionTable = false;
+    pruned.fixedArity = false;
+    SolveOptions ordered;
+    ordered.transpositionTable = false;
+    ordered.fixedArity = false;
+    SolveOptions cached;
+    cached.fixedArity = false;
+    SolveOptions fixedArity;
+
+    benchmarkMode("exhaustive", hands, exhaustive);
+    benchmarkMode("pruned", hands, pruned);
+    benchmarkMode("pruned+ordered", hands, ordered);
+    benchmarkMode("pruned+ordered+tt", hands, cached);
+    benchmarkMode("fixed solve<4>", hands, fixedArity);
+}
+
+
+void runParallelBenchmark(int threads) {
+    // Most random large hands are solved within a few thousand nodes, so
+    // the parallel search is timed on the slowest ones of a fixed sample.
+    // solve24Parallel() never runs more workers than hardware threads.
+    cout << "hardware threads: " << thread::hardware_concurrency() << endl;
+    mt19937 rng(2309);
+    uniform_int_distribution<int> card(1, 13);
+    for (size_t size = 6; size <= 7; size++) {
+        const int sampleCount = 500;
+        const size_t slowestCount = 20;
+        vector<pair<long long, vector<double>>> sample;
+        for (int h = 0; h < sampleCount; h++) {
+            vector<double> nums;
+            vector<string> exprs;
+            for (size_t i = 0; i < size; i++) {
+                nums.push_back(card(rng));
+                exprs.push_back(to_string((int)nums.back()));
+            }
+            string solution;
+            SolveStats stats;
+            solve24(nums, exprs, solution, SolveOptions(), &stats);
+            sample.push_back({stats.nodes, nums});
+        }
+        sort(sample.rbegin(), sample.rend());
+        sample.resize(slowestCount);
+
+        double serialMs = 0;
+        double parallelMs = 0;
+        long long serialNodes = 0;
+        long long parallelNodes = 0;
+        int mismatches = 0;
+        for (const auto& entry : sample) {
+            vector<double> nums = entry.second;
+            vector<string> exprs;
+            for (double value : nums) {
+                exprs.push_back(to_string((int)value));
+            }
+
+            string solution;
+            SolveStats serialStats;
+            auto start = chrono::steady_clock::now();
+            SolveResult serial = solve24(nums, exprs, solution, SolveOptions(), SolveLimits(), &serialStats);
+            auto middle = chrono::steady_clock::now();
+            SolveStats parallelStats;
+            SolveResult parallel = solve24Parallel(nums, exprs, solution, threads, SolveOptions(), SolveLimits(), &parallelStats);
+            auto end = chrono::steady_clock::now();
+
+            serialMs += chrono::duration<double, milli>(middle - start).count();
+            parallelMs += chrono::duration<double, milli>(end - middle).count();
+            serialNodes += serialStats.nodes;
+            parallelNodes += parallelStats.nodes;
+            if (serial != parallel) mismatches++;
+        }
+
+        cout << size << " cards, slowest " << slowestCount << " of " << sampleCount << ", " << threads
+             << " threads: serial " << fixed << setprecision(1) << serialMs << " ms / " << serialNodes
+             << " nodes, parallel " << parallelMs << " ms / " << parallelNodes << " nodes, speedup "
+             << setprecision(2) << serialMs / max(parallelMs, 1e-9) << "x";
+        if (mismatches > 0) {
+            cout << ", " << mismatches << " MISMATCHED RESULTS";
+        }
+        cout << endl;
+    }
 }
 
 
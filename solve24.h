@@ -1,9 +1,116 @@
 #ifndef SOLVE24_H
 #define SOLVE24_H
 
+#include <atomic>
+#include <chrono>
 #include <string>
 #include <vector>
 
+struct ReachableTargets {
+    std::vector<bool> reachable;
+    std::vector<std::string> witnesses;
+};
+
+struct SolveOptions {
+    // Cut symmetric and provably unreachable subtrees. When false the
+    // original exhaustive permutation search runs instead.
+    bool prune = true;
+    // Try the results closest to 24 first (pruned search only).
+    bool orderMoves = true;
+    // Remember multisets of values that cannot reach 24 and cut repeats of
+    // them within one search (pruned search only).
+    bool transpositionTable = true;
+    // Solve 4-card hands with the unrolled fixed-size solve<4>() instead;
+    // the options above then only apply to other hand sizes.
+    bool fixedArity = true;
+};
+
+struct SolveStats {
+    long long nodes = 0;
+    long long deadStateHits = 0;
+};
+
+enum class SolveResult { Solved, Unsolvable, GaveUp };
+
+// Limits for one search; the defaults mean no limit. nodeBudget is counted
+// from the start of the call, and cancel may be flipped from any thread.
+struct SolveLimits {
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+    long long nodeBudget = 0;
+    const std::atomic<bool>* cancel = nullptr;
+};
+
 bool solve24(std::vector<double>& nums, std::vector<std::string>& exprs, std::string& solution);
+bool solve24(std::vector<double>& nums, std::vector<std::string>& exprs, std::string& solution,
+             const SolveOptions& options, SolveStats* stats = nullptr);
+SolveResult solve24(std::vector<double>& nums, std::vector<std::string>& exprs, std::string& solution,
+                    const SolveOptions& options, const SolveLimits& limits, SolveStats* stats = nullptr);
+
+// Same search split across `threads` workers for large hands (6-7 cards):
+// the top two levels become tasks on per-worker deques, idle workers steal
+// from the others (or sleep until there is work), and the first solution
+// found stops everyone. threads is capped at the hardware thread count.
+// Hands of 5 or fewer cards, threads <= 1 or options.prune == false run the
+// serial solve24(); orderMoves and transpositionTable apply as usual, and
+// with fixedArity 4-card tasks use solve<4>(). nodeBudget and limits.cancel
+// are checked between tasks; the deadline inside them too.
+SolveResult solve24Parallel(std::vector<double>& nums, std::vector<std::string>& exprs, std::string& solution,
+                            int threads, const SolveOptions& options = SolveOptions(),
+                            const SolveLimits& limits = SolveLimits(), SolveStats* stats = nullptr);
+
+// Resumable depth-first enumeration of the pruned search, kept on an explicit
+// stack so the caller can run it in bounded slices (e.g. from an idle
+// callback). Each call to next() explores at most maxNodes nodes.
+class SolutionGenerator {
+public:
+    enum class Status { Found, Paused, Exhausted };
+
+    SolutionGenerator(const std::vector<double>& nums, const std::vector<std::string>& exprs);
+    ~SolutionGenerator();
+
+    Status next(std::string& solution, long long maxNodes);
+    bool done() const;
+    long long nodes() const { return exploredNodes; }
+
+private:
+    struct Frame;
+    std::vector<Frame> stack;
+    long long exploredNodes;
+    bool pendingRoot;
+    std::string rootExpr;
+};
+
+// Every integer in 1..maxTarget the full hand can make, indexed by target,
+// found in a single search together with one expression per target when
+// withWitnesses is set. Both vectors stop at the hand's largest reachable
+// integer (or are empty if there is none or maxTarget < 1).
+ReachableTargets reachableTargets(const std::vector<double>& nums, const std::vector<std::string>& exprs, int maxTarget,
+                                  bool withWitnesses = true);
+
+// Input may be plain, gzip or zstd (detected from its content); the output
+// is compressed when outputPath ends in .gz or .zst.
+struct BatchOptions {
+    std::string inputPath = "test.txt";
+    std::string outputPath = "test_result.txt";
+    int targetLimit = 0;
+    // Per-line limits; a line that hits one is written as "? <line>".
+    int lineTimeoutMs = 0;
+    long long lineNodeBudget = 0;
+    // Chrome trace output (needs a -DGAME24_TRACE build); every
+    // traceSampleEvery-th line gets per-line spans.
+    std::string tracePath;
+    int traceSampleEvery = 100;
+};
+
+// Parses a line of 4 cards (A, 2-10, J, Q, K); on failure `result` gets a
+// "! ..." message.
+bool parseHand(const std::string& line, std::vector<double>& nums, std::vector<std::string>& exprs,
+               std::string& result);
+bool processLine(const std::string& line, std::string& result, std::string& solution,
+                 const SolveLimits& limits = SolveLimits());
+void processConsoleInput();
+void processFileInput(const BatchOptions& options = BatchOptions());
+void runBenchmark();
+void runParallelBenchmark(int threads);
 
 #endif 
\ No newline at end of file
@@ -0,0 +1,126 @@
+#include "trace.h"
+#include <iostream>
+
+#ifdef GAME24_TRACE
+
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace trace {
+
+struct Event {
+    const char* name;
+    long long beginNs;
+    long long durationNs;
+};
+
+struct ThreadBuffer {
+    int tid;
+    std::string name;
+    std::vector<Event> events;
+};
+
+bool active = false;
+thread_local bool sampled = true;
+
+static std::mutex buffersMutex;
+static std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+static std::chrono::steady_clock::time_point epoch;
+static std::string outputPath;
+static int sampleEvery = 1;
+
+static ThreadBuffer& threadBuffer() {
+    thread_local std::shared_ptr<ThreadBuffer> buffer;
+    if (!buffer) {
+        std::lock_guard<std::mutex> lock(buffersMutex);
+        buffer = std::make_shared<ThreadBuffer>();
+        buffer->tid = (int)buffers.size() + 1;
+        buffers.push_back(buffer);
+    }
+    return *buffer;
+}
+
+void sample(long long index) {
+    sampled = index % sampleEvery == 0;
+}
+
+void threadName(const char* name) {
+    if (active) {
+        threadBuffer().name = name;
+    }
+}
+
+void record(const char* name, std::chrono::steady_clock::time_point begin,
+            std::chrono::steady_clock::time_point end) {
+    long long beginNs = std::chrono::duration_cast<std::chrono::nanoseconds>(begin - epoch).count();
+    long long durationNs = std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count();
+    threadBuffer().events.push_back({name, beginNs, durationNs});
+}
+
+}
+
+bool traceStart(const std::string& path, int sampleEvery) {
+    std::lock_guard<std::mutex> lock(trace::buffersMutex);
+    for (auto& buffer : trace::buffers) {
+        buffer->events.clear();
+    }
+    trace::outputPath = path;
+    trace::sampleEvery = sampleEvery > 0 ? sampleEvery : 1;
+    trace::epoch = std::chrono::steady_clock::now();
+    trace::active = true;
+    return true;
+}
+
+bool traceStop() {
+    if (!trace::active) {
+        return false;
+    }
+    trace::active = false;
+    trace::sampled = true;
+
+    std::ofstream out(trace::outputPath);
+    if (!out.is_open()) {
+        std::cout << "Cannot open trace file!" << std::endl;
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(trace::buffersMutex);
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    char number[64];
+    for (auto& buffer : trace::buffers) {
+        if (!buffer->name.empty()) {
+            out << (first ? "\n" : ",\n")
+                << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->tid
+                << ",\"args\":{\"name\":\"" << buffer->name << "\"}}";
+            first = false;
+        }
+        for (const trace::Event& event : buffer->events) {
+            snprintf(number, sizeof(number), "\"ts\":%.3f,\"dur\":%.3f",
+                     event.beginNs / 1000.0, event.durationNs / 1000.0);
+            out << (first ? "\n" : ",\n")
+                << "{\"name\":\"" << event.name << "\",\"ph\":\"X\"," << number
+                << ",\"pid\":1,\"tid\":" << buffer->tid << "}";
+            first = false;
+        }
+        buffer->events.clear();
+    }
+    out << "\n]}\n";
+    return true;
+}
+
+#else
+
+bool traceStart(const std::string&, int) {
+    std::cout << "Tracing is not available in this build (compile with -DGAME24_TRACE)" << std::endl;
+    return false;
+}
+
+bool traceStop() {
+    return false;
+}
+
+#endif
@@ -0,0 +1,64 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <string>
+
+// Chrome trace-event export for batch runs (load the JSON in Perfetto or
+// chrome://tracing). Compiled in only with -DGAME24_TRACE; otherwise the
+// macros expand to nothing and traceStart() reports that it is unavailable.
+//
+// Events are buffered per thread. TRACE_STAGE spans (chunk reads, queue
+// waits, output flushes) are always recorded; TRACE_SCOPE spans follow the
+// sampling set by TRACE_SAMPLE(n), which traces every sampleEvery-th item so
+// per-line spans stay cheap on long runs.
+
+bool traceStart(const std::string& path, int sampleEvery);
+bool traceStop();
+
+#ifdef GAME24_TRACE
+
+#include <chrono>
+
+namespace trace {
+
+extern bool active;
+extern thread_local bool sampled;
+
+void sample(long long index);
+void threadName(const char* name);
+void record(const char* name, std::chrono::steady_clock::time_point begin,
+            std::chrono::steady_clock::time_point end);
+
+class Scope {
+public:
+    Scope(const char* name, bool always) : name(active && (always || sampled) ? name : nullptr) {
+        if (this->name) begin = std::chrono::steady_clock::now();
+    }
+    ~Scope() {
+        if (name) record(name, begin, std::chrono::steady_clock::now());
+    }
+
+private:
+    const char* name;
+    std::chrono::steady_clock::time_point begin;
+};
+
+}
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(name) trace::Scope TRACE_CONCAT(traceScope, __LINE__)(name, false)
+#define TRACE_STAGE(name) trace::Scope TRACE_CONCAT(traceScope, __LINE__)(name, true)
+#define TRACE_SAMPLE(index) trace::sample(index)
+#define TRACE_THREAD_NAME(name) trace::threadName(name)
+
+#else
+
+#define TRACE_SCOPE(name) ((void)0)
+#define TRACE_STAGE(name) ((void)0)
+#define TRACE_SAMPLE(index) ((void)0)
+#define TRACE_THREAD_NAME(name) ((void)0)
+
+#endif
+
+#endif
@@ -0,0 +1,129 @@
+#include "verifier.h"
+#include "batch_io.h"
+#include "game_session.h"
+#include "solve24.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+namespace {
+
+void verifySlice(const std::vector<std::string>& records, size_t begin, size_t end,
+                 std::vector<Verdict>& verdicts) {
+    for (size_t i = begin; i < end; i++) {
+        verdicts[i] = verifyRecord(records[i]);
+    }
+}
+
+}
+
+Verdict verifyRecord(const std::string& record) {
+    size_t separator = record.find(';');
+    if (separator == std::string::npos) {
+        return Verdict::Malformed;
+    }
+
+    std::vector<double> nums;
+    std::vector<std::string> exprs;
+    std::string error;
+    if (!parseHand(record.substr(0, separator), nums, exprs, error)) {
+        return Verdict::Malformed;
+    }
+    std::vector<int> cards(nums.begin(), nums.end());
+
+    std::string answer = record.substr(separator + 1);
+    double value;
+    try {
+        value = GameSession::evaluateExpression(answer);
+    } catch (const MalformedExpression&) {
+        return Verdict::Malformed;
+    } catch (const std::runtime_error&) {
+        // Division by zero is a well-formed wrong answer, not a bad record.
+        return Verdict::Incorrect;
+    }
+    // The same two checks as GameSession::validateAnswer, with the
+    // expression evaluated only once.
+    if (!GameSession::usesExactlyCards(cards, answer) || std::fabs(value - 24.0) >= 1e-6) {
+        return Verdict::Incorrect;
+    }
+    return Verdict::Correct;
+}
+
+bool verifyFile(const std::string& inputPath, const std::string& outputPath, int threads,
+                VerifyReport& report) {
+    if (threads < 1) threads = 1;
+    auto begin = std::chrono::steady_clock::now();
+
+    LineSource inFile(inputPath, 16384);
+    if (!inFile.isOpen()) {
+        std::cout << "Cannot open input file!" << std::endl;
+        return false;
+    }
+    LineSink outFile(outputPath, compressionForPath(outputPath));
+    if (!outFile.isOpen()) {
+        std::cout << "Cannot open output file!" << std::endl;
+        return false;
+    }
+
+    std::vector<std::string> lines;
+    std::vector<std::string> records;
+    std::vector<Verdict> verdicts;
+    while (inFile.next(lines)) {
+        records.clear();
+        for (std::string& line : lines) {
+            if (!line.empty()) records.push_back(std::move(line));
+        }
+        verdicts.assign(records.size(), Verdict::Malformed);
+
+        // Each batch is split into contiguous slices so verdicts stay in input order.
+        std::vector<std::thread> workers;
+        size_t slice = (records.size() + threads - 1) / threads;
+        for (int t = 1; t < threads && t * slice < records.size(); t++) {
+            size_t end = std::min(records.size(), (t + 1) * slice);
+            workers.emplace_back(verifySlice, std::cref(records), t * slice, end, std::ref(verdicts));
+        }
+        verifySlice(records, 0, std::min(records.size(), slice), verdicts);
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+
+        for (size_t i = 0; i < records.size(); i++) {
+            switch (verdicts[i]) {
+                case Verdict::Correct:
+                    report.correct++;
+                    outFile.writeLine("+ " + records[i]);
+                    break;
+                case Verdict::Incorrect:
+                    report.incorrect++;
+                    outFile.writeLine("- " + records[i]);
+                    break;
+                case Verdict::Malformed:
+                    report.malformed++;
+                    outFile.writeLine("! " + records[i]);
+                    break;
+            }
+        }
+    }
+
+    // As in processFileInput(), a failed read replaces the totals line.
+    std::string error = inFile.error();
+    if (error.empty()) {
+        outFile.writeLine("correct " + std::to_string(report.correct) + ", incorrect " +
+                          std::to_string(report.incorrect) + ", malformed " + std::to_string(report.malformed));
+    } else {
+        outFile.writeLine("! " + error);
+    }
+
+    if (!outFile.close()) {
+        error = "Cannot write output file!";
+    }
+    report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    if (!error.empty()) {
+        std::cout << error << std::endl;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,29 @@
+#ifndef VERIFIER_H
+#define VERIFIER_H
+
+#include <string>
+
+enum class Verdict {
+    Correct,
+    Incorrect,
+    Malformed
+};
+
+struct VerifyReport {
+    long long correct = 0;
+    long long incorrect = 0;
+    long long malformed = 0;
+    double seconds = 0;
+};
+
+// Grades one "hand ; expression" record against its own hand with the same
+// rules as the game. Malformed means the record has no ';', the hand does
+// not parse, or the expression cannot be evaluated.
+Verdict verifyRecord(const std::string& record);
+
+// Grades every record of `inputPath` on `threads` threads and writes one
+// "+ ", "- " or "! " line per record, followed by the totals.
+bool verifyFile(const std::string& inputPath, const std::string& outputPath, int threads,
+                VerifyReport& report);
+
+#endif